@@ -6,6 +6,7 @@
 #include <stdbool.h>
 #include <string.h>
 #include <stdint.h>
+#include <stdio.h>
 
 #include "esp_log.h"
 #include "nvs_flash.h"
@@ -17,6 +18,10 @@
 #include "driver/gpio.h"
 
 #include "shs01.h"
+#include "shs_radar.h"
+#include "shs_hold.h"
+#include "shs_track.h"
+#include "shs_interf.h"
 #include "ha/esp_zigbee_ha_standard.h"
 #include "zcl_utility.h"
 #include "light_driver.h"
@@ -37,19 +42,70 @@ static const char *SHS_TAG = "SHS01";
 #define SHS_NVS_KEY_OCC_CD      "occ_cd"    /* u16 */
 #define SHS_NVS_KEY_MV_SENS     "mv_sens"   /* u8  0..100 */
 #define SHS_NVS_KEY_ST_SENS     "st_sens"   /* u8  0..100 */
-#define SHS_NVS_KEY_MV_GATE     "mv_gate"   /* u8  0..8   */
-#define SHS_NVS_KEY_ST_GATE     "st_gate"   /* u8  2..8   */
+#define SHS_NVS_KEY_MV_GATE     "mv_gate"   /* u8  0..max_gate */
+#define SHS_NVS_KEY_ST_GATE     "st_gate"   /* u8  min_static_gate..max_gate */
+#define SHS_NVS_KEY_BAUD        "baud"      /* u32 last locked radar baud */
+#define SHS_NVS_KEY_BAUD_NOUP   "baud_noup" /* u32 upgrade rate the module refused */
+#define SHS_NVS_KEY_MV_GTHR     "mv_gthr"   /* blob u8[gates] 0..100 */
+#define SHS_NVS_KEY_ST_GTHR     "st_gthr"   /* blob u8[gates] 0..100 */
+#define SHS_NVS_KEY_DIST_RES    "dist_res"  /* u8  0 = 0.75 m, 1 = 0.2 m */
+#define SHS_NVS_KEY_MV_AS       "mv_as"     /* u16 ms */
+#define SHS_NVS_KEY_ST_AS       "st_as"     /* u16 ms */
+#define SHS_NVS_KEY_ST_CL       "st_cl"     /* u16 s */
+#define SHS_NVS_KEY_OCC_AS      "occ_as"    /* u16 ms */
+#define SHS_NVS_KEY_OCC_CL      "occ_cl"    /* u16 s */
+#define SHS_NVS_KEY_ZONES       "zones"     /* blob shs_zone_cfg_t[SHS_ZONE_COUNT] */
+#define SHS_NVS_KEY_PRETRIG     "pre_cm"    /* u16 cm, 0 = off */
+#define SHS_NVS_KEY_INTERF      "interf"    /* u8  0/1 */
 
 /* ---------------- Backing store for config sliders ---------------- */
 static uint16_t shs_movement_cooldown_sec = 0;  /* 0..300 */
 static uint16_t shs_occupancy_clear_sec   = 0;  /* 0..65535 */
 
+/* Firmware hold delays: assert 0..SHS_HOLD_ASSERT_MAX_MS, clear 0..SHS_COOLDOWN_MAX_SEC */
+static uint16_t shs_mv_assert_ms          = 0;
+static uint16_t shs_st_assert_ms          = 0;
+static uint16_t shs_st_clear_sec          = 0;
+static uint16_t shs_occ_assert_ms         = 0;
+static uint16_t shs_occ_clear_sec         = 0;
+
 static uint8_t  shs_moving_sens_0_100     = 60;  /* 0..100 */
 static uint8_t  shs_static_sens_0_100     = 50;  /* 0..100 */
 
-/* Gates are 16-bit so EP1 attributes can point directly (U16 type) */
-static uint16_t shs_moving_max_gate       = 8;   /* 0..8 (0..6.0 m) */
-static uint16_t shs_static_max_gate       = 8;   /* 2..8 (0.75..6.0 m) */
+/* Gates are 16-bit so EP1 attributes can point directly (U16 type);
+ * limits come from the driver (LD2410 0..8, LD2412 0..13), size from shs_dist_res */
+static uint16_t shs_moving_max_gate       = 8;   /* 0..max_gate */
+static uint16_t shs_static_max_gate       = 8;   /* min_static_gate..max_gate */
+
+/* Gate size: 0 = SHS_RADAR_GATE_CM, 1 = SHS_RADAR_GATE_CM_FINE (fine_res drivers only) */
+static uint16_t shs_dist_res              = 0;
+
+/* Per-gate thresholds (0 = follow the global sensitivity); U16 for EP1 attributes */
+static uint16_t shs_mv_gate_thr[SHS_RADAR_MAX_GATES];
+static uint16_t shs_st_gate_thr[SHS_RADAR_MAX_GATES];
+
+/* Distance zones: a target whose reported distance lies in [start_cm, end_cm] occupies
+ * the zone; U16 fields for EP1 attributes */
+typedef struct {
+    uint16_t start_cm;
+    uint16_t end_cm;            /* 0 = zone off */
+    uint16_t clear_s;           /* zone hold, 0..SHS_COOLDOWN_MAX_SEC */
+} shs_zone_cfg_t;
+static shs_zone_cfg_t shs_zones[SHS_ZONE_COUNT];
+
+/* Pre-trigger distance (cm, 0 = off): see SHS_ATTR_PRETRIGGER_CM */
+static uint16_t shs_pretrigger_cm         = 0;
+
+/* Interference suppression on/off (0/1); opt-in */
+static uint16_t shs_interf_enable         = 0;
+
+/* Radar UART baud (NVS-cached result of the boot-time probe; 0 = driver default) */
+static uint32_t shs_radar_baud            = 0;
+/* Upgrade rate a previous boot failed to switch to (NVS); not retried */
+static uint32_t shs_radar_baud_noup       = 0;
+
+/* Calibration window while running (EP1 attribute), 0 when idle */
+static uint16_t shs_calib_s               = 0;
 
 /* Proxies exposed on EP1 for 0..10 slider READs (kept in sync with 0..100) */
 static uint16_t shs_sens_mv_0_10          = 6;
@@ -58,12 +114,57 @@ static uint16_t shs_sens_st_0_10          = 5;
 /* ---------------- Published states ---------------- */
 static bool shs_moving_state    = false; /* moving target */
 static bool shs_static_state    = false; /* static target */
-static bool shs_occupancy_state = false; /* overall occupancy (moving || static) */
-
-/* ---------------- Movement cooldown state (for moving target) ---------------- */
-static bool     shs_mv_cooldown_active      = false;
-static uint32_t shs_mv_cooldown_deadline_ms = 0;
-static bool     shs_last_moving_sample      = false;
+static bool shs_occupancy_state = false; /* overall occupancy (moving || static || OUT pin) */
+static bool shs_zone_state[SHS_ZONE_COUNT];
+static uint8_t shs_target_dir   = SHS_TRACK_NONE; /* tracker direction (EP2, U8) */
+static uint8_t shs_confidence   = 0;              /* presence confidence 0..100 (EP2, U8) */
+static uint16_t shs_conf_q8     = 0;              /* smoothed confidence, Q8 */
+static uint8_t shs_conf_raw     = 0;              /* last new frame's score */
+static uint32_t shs_conf_frames = 0;              /* good_frames already smoothed in */
+
+/* ---------------- OUT pin / link state (radar task) ---------------- */
+static bool     shs_frame_presence = false; /* targets in the last parsed frame */
+static volatile uint32_t shs_presence_ms = 0; /* last time occupancy was seen (drift check waits for quiet) */
+static volatile bool shs_link_stale = false; /* no frames for SHS_RADAR_LINK_STALE_MS (read by the watchdog) */
+static uint32_t shs_link_frames    = 0;     /* good_frames at the last check */
+static uint32_t shs_link_alive_ms  = 0;
+
+/* Link state as seen by the watchdog (EP1 diagnostic, U32) */
+typedef enum {
+    SHS_LINK_UP         = 0,
+    SHS_LINK_RECOVERING = 1,    /* stale, recovery steps in progress */
+    SHS_LINK_DOWN       = 2,    /* every step tried; retried periodically */
+} shs_link_state_t;
+static uint32_t shs_link_state = SHS_LINK_UP;
+
+/* ---------------- Hold channels (radar task) ---------------- */
+static void shs_hold_changed(shs_hold_t *h, bool state);
+static shs_hold_t shs_hold_mv  = { .name = "Moving Target", .assert_ms = &shs_mv_assert_ms,
+                                   .clear_s = &shs_movement_cooldown_sec, .on_change = shs_hold_changed };
+static shs_hold_t shs_hold_st  = { .name = "Static Target", .assert_ms = &shs_st_assert_ms,
+                                   .clear_s = &shs_st_clear_sec, .on_change = shs_hold_changed };
+static shs_hold_t shs_hold_occ = { .name = "Occupancy", .assert_ms = &shs_occ_assert_ms,
+                                   .clear_s = &shs_occ_clear_sec, .on_change = shs_hold_changed };
+/* zones assert like overall occupancy and clear after their own hold */
+static shs_hold_t shs_hold_zone[SHS_ZONE_COUNT] = {
+    { .name = "Zone 1", .assert_ms = &shs_occ_assert_ms, .clear_s = &shs_zones[0].clear_s, .on_change = shs_hold_changed },
+    { .name = "Zone 2", .assert_ms = &shs_occ_assert_ms, .clear_s = &shs_zones[1].clear_s, .on_change = shs_hold_changed },
+    { .name = "Zone 3", .assert_ms = &shs_occ_assert_ms, .clear_s = &shs_zones[2].clear_s, .on_change = shs_hold_changed },
+    { .name = "Zone 4", .assert_ms = &shs_occ_assert_ms, .clear_s = &shs_zones[3].clear_s, .on_change = shs_hold_changed },
+};
+_Static_assert(SHS_ZONE_COUNT == 4, "shs_hold_zone initialisers");
+
+/* ---------------- Target tracker (radar task) ---------------- */
+static shs_track_t shs_track;
+static bool     shs_track_has     = false;  /* last tracker input, replayed while frames repeat */
+static uint16_t shs_track_dist_cm = 0;
+static uint32_t shs_track_step_ms = 0;
+
+/* ---------------- Interference suppression (radar task) ---------------- */
+static shs_interf_t  shs_interf;
+static volatile bool shs_interf_reset_req = false; /* gate layout or switch changed */
+static uint32_t      shs_interf_gates      = 0;     /* masked gates (EP1 diagnostic, U32) */
+static uint32_t      shs_interf_suppressed = 0;
 
 /* Zigbee stack ready flag: only write attrs when true */
 static volatile bool shs_zb_ready = false;
@@ -73,8 +174,10 @@ typedef enum {
     SHS_SAVE_IMMEDIATE_U16,
     SHS_SAVE_DEBOUNCE_SENS_MOVE,   /* 0..100 */
     SHS_SAVE_DEBOUNCE_SENS_STATIC, /* 0..100 */
-    SHS_SAVE_DEBOUNCE_GATE_MOVE,   /* 0..8 */
-    SHS_SAVE_DEBOUNCE_GATE_STATIC, /* 2..8 */
+    SHS_SAVE_DEBOUNCE_GATE_MOVE,   /* 0..max_gate */
+    SHS_SAVE_DEBOUNCE_GATE_STATIC, /* min_static_gate..max_gate */
+    SHS_SAVE_DEBOUNCE_GATE_THR,    /* both per-gate tables */
+    SHS_SAVE_DEBOUNCE_ZONES,       /* zone table */
 } shs_save_evt_t;
 
 typedef struct {
@@ -84,12 +187,46 @@ typedef struct {
 
 static QueueHandle_t shs_save_q;
 
+/* ---------------- Radar command worker ----------------
+ * Owns all radar TX: the Zigbee handler only queues SHS_RADAR_CFG_* bits. */
+static QueueHandle_t shs_radar_cmd_q;
+
+/* Hold delay attributes (the moving clear delay keeps its own handler) */
+typedef struct {
+    uint16_t    attr;
+    const char *key;
+    uint16_t   *val;
+    uint16_t    max;
+    const char *what;
+} shs_hold_attr_t;
+
+static const shs_hold_attr_t shs_hold_attrs[] = {
+    { SHS_ATTR_MOVING_ASSERT_MS, SHS_NVS_KEY_MV_AS,  &shs_mv_assert_ms,  SHS_HOLD_ASSERT_MAX_MS, "Moving Target Assert Delay" },
+    { SHS_ATTR_STATIC_ASSERT_MS, SHS_NVS_KEY_ST_AS,  &shs_st_assert_ms,  SHS_HOLD_ASSERT_MAX_MS, "Static Target Assert Delay" },
+    { SHS_ATTR_STATIC_CLEAR_S,   SHS_NVS_KEY_ST_CL,  &shs_st_clear_sec,  SHS_COOLDOWN_MAX_SEC,   "Static Target Clear Delay" },
+    { SHS_ATTR_OCC_ASSERT_MS,    SHS_NVS_KEY_OCC_AS, &shs_occ_assert_ms, SHS_HOLD_ASSERT_MAX_MS, "Occupancy Assert Delay" },
+    { SHS_ATTR_OCC_CLEAR_S,      SHS_NVS_KEY_OCC_CL, &shs_occ_clear_sec, SHS_COOLDOWN_MAX_SEC,   "Occupancy Clear Delay" },
+};
+
+static const shs_hold_attr_t *shs_hold_attr_find(uint16_t attr_id)
+{
+    for (size_t i = 0; i < sizeof(shs_hold_attrs) / sizeof(shs_hold_attrs[0]); ++i) {
+        if (shs_hold_attrs[i].attr == attr_id) return &shs_hold_attrs[i];
+    }
+    return NULL;
+}
+
 /* ---------------- Helpers ---------------- */
 static inline bool shs_time_reached(uint32_t now, uint32_t deadline)
 {
     return (int32_t)(now - deadline) >= 0;
 }
 
+static inline unsigned shs_gate_cm(void)
+{
+    return shs_dist_res ? SHS_RADAR_GATE_CM_FINE : SHS_RADAR_GATE_CM;
+}
+
 static void shs_cfg_save_u16(const char *key, uint16_t v)
 {
     nvs_handle_t h;
@@ -108,6 +245,64 @@ static void shs_cfg_save_u8(const char *key, uint8_t v)
     nvs_close(h);
 }
 
+static void shs_cfg_save_u32(const char *key, uint32_t v)
+{
+    nvs_handle_t h;
+    if (nvs_open(SHS_NVS_NAMESPACE, NVS_READWRITE, &h) != ESP_OK) return;
+    nvs_set_u32(h, key, v);
+    nvs_commit(h);
+    nvs_close(h);
+}
+
+static void shs_cfg_save_gate_thr(const char *key, const uint16_t *thr)
+{
+    uint8_t blob[SHS_RADAR_MAX_GATES];
+    for (size_t g = 0; g < SHS_RADAR_MAX_GATES; ++g) blob[g] = (uint8_t)thr[g];
+
+    nvs_handle_t h;
+    if (nvs_open(SHS_NVS_NAMESPACE, NVS_READWRITE, &h) != ESP_OK) return;
+    nvs_set_blob(h, key, blob, sizeof(blob));
+    nvs_commit(h);
+    nvs_close(h);
+}
+
+static void shs_cfg_save_zones(void)
+{
+    nvs_handle_t h;
+    if (nvs_open(SHS_NVS_NAMESPACE, NVS_READWRITE, &h) != ESP_OK) return;
+    nvs_set_blob(h, SHS_NVS_KEY_ZONES, shs_zones, sizeof(shs_zones));
+    nvs_commit(h);
+    nvs_close(h);
+}
+
+/* Clamp and store one zone field (range at the current gate size); returns the stored value */
+static uint16_t shs_cfg_set_zone_field(size_t zone, uint16_t field, uint16_t v)
+{
+    const uint16_t max_cm = (uint16_t)((shs_radar_driver.max_gate + 1) * shs_gate_cm());
+    shs_zone_cfg_t *zc = &shs_zones[zone];
+    switch (field) {
+        case SHS_ZONE_FIELD_START_CM: return zc->start_cm = v > max_cm ? max_cm : v;
+        case SHS_ZONE_FIELD_END_CM:   return zc->end_cm = v > max_cm ? max_cm : v;
+        default:                      return zc->clear_s = v > SHS_COOLDOWN_MAX_SEC ? SHS_COOLDOWN_MAX_SEC : v;
+    }
+}
+
+static void shs_cfg_load_gate_thr(nvs_handle_t h, const char *key, uint16_t *thr)
+{
+    uint8_t blob[SHS_RADAR_MAX_GATES];
+    size_t len = sizeof(blob);
+    if (nvs_get_blob(h, key, blob, &len) != ESP_OK) return;
+    for (size_t g = 0; g < len && g < SHS_RADAR_MAX_GATES; ++g) thr[g] = blob[g] > 100 ? 100 : blob[g];
+}
+
+static inline void shs_radar_cmd_enqueue(uint32_t what)
+{
+    if (!shs_radar_cmd_q) return;
+    if (xQueueSend(shs_radar_cmd_q, &what, 0) != pdTRUE) {
+        ESP_LOGW(SHS_TAG, "Radar command queue full, dropped apply 0x%02x", (unsigned)what);
+    }
+}
+
 static inline void shs_save_enqueue(shs_save_evt_t t, uint16_t v)
 {
     if (!shs_save_q) return;
@@ -132,27 +327,53 @@ static void shs_cfg_load_from_nvs(void)
         return;
     }
 
-    uint16_t u16tmp; uint8_t u8tmp;
+    uint16_t u16tmp; uint8_t u8tmp; uint32_t u32tmp;
 
     if (nvs_get_u16(h, SHS_NVS_KEY_MV_CD,  &u16tmp) == ESP_OK) shs_movement_cooldown_sec = (u16tmp > SHS_COOLDOWN_MAX_SEC) ? SHS_COOLDOWN_MAX_SEC : u16tmp;
     if (nvs_get_u16(h, SHS_NVS_KEY_OCC_CD, &u16tmp) == ESP_OK) shs_occupancy_clear_sec   = u16tmp;
+    if (nvs_get_u16(h, SHS_NVS_KEY_PRETRIG, &u16tmp) == ESP_OK) shs_pretrigger_cm        = u16tmp;
+    for (size_t i = 0; i < sizeof(shs_hold_attrs) / sizeof(shs_hold_attrs[0]); ++i) {
+        const shs_hold_attr_t *a = &shs_hold_attrs[i];
+        if (nvs_get_u16(h, a->key, &u16tmp) == ESP_OK) *a->val = (u16tmp > a->max) ? a->max : u16tmp;
+    }
 
     if (nvs_get_u8(h,  SHS_NVS_KEY_MV_SENS, &u8tmp) == ESP_OK) shs_moving_sens_0_100 = (u8tmp > 100) ? 100 : u8tmp;
     if (nvs_get_u8(h,  SHS_NVS_KEY_ST_SENS, &u8tmp) == ESP_OK) shs_static_sens_0_100 = (u8tmp > 100) ? 100 : u8tmp;
 
-    if (nvs_get_u8(h,  SHS_NVS_KEY_MV_GATE, &u8tmp) == ESP_OK) shs_moving_max_gate = (u8tmp > 8) ? 8 : u8tmp;
+    const uint8_t max_gate = shs_radar_driver.max_gate, min_st_gate = shs_radar_driver.min_static_gate;
+    if (nvs_get_u8(h,  SHS_NVS_KEY_MV_GATE, &u8tmp) == ESP_OK) shs_moving_max_gate = (u8tmp > max_gate) ? max_gate : u8tmp;
     if (nvs_get_u8(h,  SHS_NVS_KEY_ST_GATE, &u8tmp) == ESP_OK) {
-        if (u8tmp < 2) u8tmp = 2; else if (u8tmp > 8) u8tmp = 8;
+        if (u8tmp < min_st_gate) u8tmp = min_st_gate; else if (u8tmp > max_gate) u8tmp = max_gate;
         shs_static_max_gate = u8tmp;
     }
+    if (nvs_get_u8(h,  SHS_NVS_KEY_INTERF, &u8tmp) == ESP_OK) shs_interf_enable = u8tmp ? 1 : 0;
+    if (nvs_get_u8(h,  SHS_NVS_KEY_DIST_RES, &u8tmp) == ESP_OK && shs_radar_driver.fine_res) shs_dist_res = u8tmp ? 1 : 0;
+    if (nvs_get_u32(h, SHS_NVS_KEY_BAUD, &u32tmp) == ESP_OK && u32tmp != 0) shs_radar_baud = u32tmp;
+    if (nvs_get_u32(h, SHS_NVS_KEY_BAUD_NOUP, &u32tmp) == ESP_OK) shs_radar_baud_noup = u32tmp;
+    shs_cfg_load_gate_thr(h, SHS_NVS_KEY_MV_GTHR, shs_mv_gate_thr);
+    shs_cfg_load_gate_thr(h, SHS_NVS_KEY_ST_GTHR, shs_st_gate_thr);
+    shs_zone_cfg_t zones[SHS_ZONE_COUNT];
+    size_t zlen = sizeof(zones);
+    if (nvs_get_blob(h, SHS_NVS_KEY_ZONES, zones, &zlen) == ESP_OK && zlen == sizeof(zones)) {
+        for (size_t z = 0; z < SHS_ZONE_COUNT; ++z) {
+            (void)shs_cfg_set_zone_field(z, SHS_ZONE_FIELD_START_CM, zones[z].start_cm);
+            (void)shs_cfg_set_zone_field(z, SHS_ZONE_FIELD_END_CM,   zones[z].end_cm);
+            (void)shs_cfg_set_zone_field(z, SHS_ZONE_FIELD_CLEAR_S,  zones[z].clear_s);
+        }
+    }
     nvs_close(h);
 
     shs_cfg_sync_sens_proxies();
 
-    ESP_LOGI(SHS_TAG, "NVS loaded: mv_cd=%us, occ_cd=%us, mv_sens=%u, st_sens=%u, mv_gate=%u, st_gate=%u",
+    ESP_LOGI(SHS_TAG, "NVS loaded: mv_cd=%us, occ_cd=%us, hold mv=%ums/%us st=%ums/%us occ=%ums/%us",
              (unsigned)shs_movement_cooldown_sec, (unsigned)shs_occupancy_clear_sec,
+             (unsigned)shs_mv_assert_ms, (unsigned)shs_movement_cooldown_sec,
+             (unsigned)shs_st_assert_ms, (unsigned)shs_st_clear_sec,
+             (unsigned)shs_occ_assert_ms, (unsigned)shs_occ_clear_sec);
+    ESP_LOGI(SHS_TAG, "NVS loaded: mv_sens=%u, st_sens=%u, mv_gate=%u, st_gate=%u, gate=%ucm, baud=%u",
              (unsigned)shs_moving_sens_0_100, (unsigned)shs_static_sens_0_100,
-             (unsigned)shs_moving_max_gate, (unsigned)shs_static_max_gate);
+             (unsigned)shs_moving_max_gate, (unsigned)shs_static_max_gate,
+             shs_gate_cm(), (unsigned)shs_radar_baud);
 }
 
 /* ---------------- Light driver init ---------------- */
@@ -161,137 +382,81 @@ static void shs_deferred_driver_init(void)
     light_driver_init(LIGHT_DEFAULT_OFF);
 }
 
-/* ---------------- LD2410C frame writers ---------------- */
-static void shs_ld2410_write_cmd(const uint8_t *payload, uint16_t payload_len)
+/* ---------------- Radar config ---------------- */
+static esp_err_t shs_radar_apply(uint32_t what)
 {
-    /* Build contiguous buffer: hdr(4) + len(2 LE) + payload + tail(4) */
-    uint16_t total = 4 + 2 + payload_len + 4;
-
-    uint8_t stackbuf[4 + 2 + 256 + 4];
-    uint8_t *p = stackbuf;
-    p[0]=SHS_LD2410_HDR_TX0; p[1]=SHS_LD2410_HDR_TX1; p[2]=SHS_LD2410_HDR_TX2; p[3]=SHS_LD2410_HDR_TX3;
-    p[4]=(uint8_t)(payload_len & 0xFF);
-    p[5]=(uint8_t)((payload_len >> 8) & 0xFF);
-    memcpy(&p[6], payload, payload_len);
-    p[6 + payload_len + 0]=SHS_LD2410_TAIL_TX0;
-    p[6 + payload_len + 1]=SHS_LD2410_TAIL_TX1;
-    p[6 + payload_len + 2]=SHS_LD2410_TAIL_TX2;
-    p[6 + payload_len + 3]=SHS_LD2410_TAIL_TX3;
-    uart_write_bytes(SHS_LD2410_UART_NUM, (const char*)stackbuf, total);
-}
-
-static inline uint16_t shs_clamp_u16(uint16_t v, uint16_t lo, uint16_t hi) { return v < lo ? lo : (v > hi ? hi : v); }
-static inline uint8_t  shs_clamp_u8 (uint8_t  v, uint8_t  lo, uint8_t  hi) { return v < lo ? lo : (v > hi ? hi : v); }
-
-static void shs_ld2410_disable_ble(void)
-{
-    vTaskDelay(pdMS_TO_TICKS(1000)); /* wait for module to be ready */
-    const uint8_t begin_cfg[] = { (SHS_LD2410_CMD_BEGIN_CONFIG & 0xFF), ((SHS_LD2410_CMD_BEGIN_CONFIG >> 8) & 0xFF), 0x01, 0x00 };
-    shs_ld2410_write_cmd(begin_cfg, sizeof(begin_cfg));
-
-    const uint8_t disable_ble[] = { (SHS_LD2410_CMD_BLE_ENABLE & 0xFF), ((SHS_LD2410_CMD_BLE_ENABLE >> 8) & 0xFF), 0x00, 0x00 };
-    shs_ld2410_write_cmd(disable_ble, sizeof(disable_ble));
-
-    const uint8_t end_cfg[] = { (SHS_LD2410_CMD_END_CONFIG & 0xFF), ((SHS_LD2410_CMD_END_CONFIG >> 8) & 0xFF) };
-    shs_ld2410_write_cmd(end_cfg, sizeof(end_cfg));
-    ESP_LOGI(SHS_TAG, "Bluetooth LE disabled on LD2410.");
-
-    vTaskDelay(pdMS_TO_TICKS(200)); /* wait a bit; the restart the module for the bluetooth disable to take effect */
-    shs_ld2410_write_cmd(begin_cfg, sizeof(begin_cfg));
-
-    const uint8_t restart_module[] = { (SHS_LD2410_CMD_RESTART_MODULE & 0xFF), ((SHS_LD2410_CMD_RESTART_MODULE >> 8) & 0xFF) };
-    shs_ld2410_write_cmd(restart_module, sizeof(restart_module));
-
-    shs_ld2410_write_cmd(end_cfg, sizeof(end_cfg));
-    
-    ESP_LOGI(SHS_TAG, "Module restart command sent to LD2410.");
-    vTaskDelay(pdMS_TO_TICKS(1000));; /* wait for module to be ready */
+    shs_radar_cfg_t cfg = {
+        .moving_sens     = shs_moving_sens_0_100,
+        .static_sens     = shs_static_sens_0_100,
+        .moving_max_gate = shs_moving_max_gate,
+        .static_max_gate = shs_static_max_gate,
+        .no_one_sec      = shs_occupancy_clear_sec,
+        .fine_res        = (uint8_t)shs_dist_res,
+    };
+    for (size_t g = 0; g < SHS_RADAR_MAX_GATES; ++g) {
+        cfg.mv_gate_thr[g] = (uint8_t)shs_mv_gate_thr[g];
+        cfg.st_gate_thr[g] = (uint8_t)shs_st_gate_thr[g];
+    }
+    return shs_radar_driver.apply_config(&cfg, what);
 }
 
-static void shs_ld2410_apply_params_all(void)
+/* ---------------- ZCL helpers ---------------- */
+static inline void shs_zb_set_occ_bitmap(uint8_t endpoint, bool occupied)
 {
-    /* belt-and-suspenders clamp */
-    uint16_t mv_gate = shs_clamp_u16(shs_moving_max_gate, 0, 8);
-    uint16_t st_gate = shs_clamp_u16(shs_static_max_gate, 2, 8);
-    uint16_t no_one  = shs_occupancy_clear_sec; /* 0..65535 */
-
-    const uint8_t begin_cfg[] = { (SHS_LD2410_CMD_BEGIN_CONFIG & 0xFF), ((SHS_LD2410_CMD_BEGIN_CONFIG >> 8) & 0xFF), 0x01, 0x00 };
-    shs_ld2410_write_cmd(begin_cfg, sizeof(begin_cfg));
-
-    uint8_t set_params[2 + (2+4)*3]; int o = 0;
-    set_params[o++] = (SHS_LD2410_CMD_SET_PARAMS & 0xFF); set_params[o++] = ((SHS_LD2410_CMD_SET_PARAMS >> 8) & 0xFF);
-
-    /* max move gate (1 byte significant) */
-    set_params[o++] = (SHS_LD2410_PW_MAX_MOVE_GATE & 0xFF); set_params[o++] = ((SHS_LD2410_PW_MAX_MOVE_GATE >> 8) & 0xFF);
-    set_params[o++] = (uint8_t)(mv_gate & 0xFF); set_params[o++] = 0x00; set_params[o++] = 0x00; set_params[o++] = 0x00;
-
-    /* max static gate (1 byte significant) */
-    set_params[o++] = (SHS_LD2410_PW_MAX_STATIC_GATE & 0xFF); set_params[o++] = ((SHS_LD2410_PW_MAX_STATIC_GATE >> 8) & 0xFF);
-    set_params[o++] = (uint8_t)(st_gate & 0xFF); set_params[o++] = 0x00; set_params[o++] = 0x00; set_params[o++] = 0x00;
-
-    /* no one duration seconds (LE16) */
-    set_params[o++] = (SHS_LD2410_PW_NO_ONE_DURATION & 0xFF); set_params[o++] = ((SHS_LD2410_PW_NO_ONE_DURATION >> 8) & 0xFF);
-    set_params[o++] = (uint8_t)(no_one & 0xFF);
-    set_params[o++] = (uint8_t)((no_one >> 8) & 0xFF);
-    set_params[o++] = 0x00; set_params[o++] = 0x00;
-
-    shs_ld2410_write_cmd(set_params, o);
-
-    const uint8_t end_cfg[] = { (SHS_LD2410_CMD_END_CONFIG & 0xFF), ((SHS_LD2410_CMD_END_CONFIG >> 8) & 0xFF) };
-    shs_ld2410_write_cmd(end_cfg, sizeof(end_cfg));
-
-    ESP_LOGI(SHS_TAG, "Applied params: move_gate=%u, static_gate=%u, no_one=%us",
-             (unsigned)mv_gate, (unsigned)st_gate, (unsigned)no_one);
+    if (!shs_zb_ready) return;
+    uint8_t v = occupied ? 1 : 0; /* Occupancy (0x0000) is bitmap8; bit0=1 means occupied */
+    esp_zb_lock_acquire(portMAX_DELAY);
+    esp_zb_zcl_set_attribute_val(endpoint,
+                                 ESP_ZB_ZCL_CLUSTER_ID_OCCUPANCY_SENSING,
+                                 ESP_ZB_ZCL_CLUSTER_SERVER_ROLE,
+                                 ESP_ZB_ZCL_ATTR_OCCUPANCY_SENSING_OCCUPANCY_ID,
+                                 &v, false);
+    esp_zb_lock_release();
 }
 
-static void shs_ld2410_apply_global_sensitivity(void)
+static inline void shs_zb_set_bool_attr(uint8_t endpoint, uint16_t cluster, uint16_t attr_id, bool value)
 {
-    /* clamp & map */
-    uint8_t mv = shs_clamp_u8(shs_moving_sens_0_100, 0, 100);
-    uint8_t st = shs_clamp_u8(shs_static_sens_0_100, 0, 100);
-
-    const uint8_t begin_cfg[] = { (SHS_LD2410_CMD_BEGIN_CONFIG & 0xFF), ((SHS_LD2410_CMD_BEGIN_CONFIG >> 8) & 0xFF), 0x01, 0x00 };
-    shs_ld2410_write_cmd(begin_cfg, sizeof(begin_cfg));
-
-    /* 0xFFFF = all gates */
-    uint8_t sens[2 + 2 + 2 + 2]; int o = 0;
-    sens[o++] = (SHS_LD2410_CMD_SET_SENSITIVITY & 0xFF); sens[o++] = ((SHS_LD2410_CMD_SET_SENSITIVITY >> 8) & 0xFF);
-    sens[o++] = (SHS_LD2410_GATE_ALL & 0xFF);            sens[o++] = ((SHS_LD2410_GATE_ALL >> 8) & 0xFF);
-    sens[o++] = mv;   sens[o++] = 0x00;  /* moving (LSB) */
-    sens[o++] = st;   sens[o++] = 0x00;  /* static (LSB) */
-
-    shs_ld2410_write_cmd(sens, o);
-
-    const uint8_t end_cfg[] = { (SHS_LD2410_CMD_END_CONFIG & 0xFF), ((SHS_LD2410_CMD_END_CONFIG >> 8) & 0xFF) };
-    shs_ld2410_write_cmd(end_cfg, sizeof(end_cfg));
-
-    ESP_LOGI(SHS_TAG, "Applied sensitivity: move=%u, static=%u", (unsigned)mv, (unsigned)st);
+    if (!shs_zb_ready) return;
+    bool v = value;
+    esp_zb_lock_acquire(portMAX_DELAY);
+    esp_zb_zcl_set_attribute_val(endpoint,
+                                 cluster,
+                                 ESP_ZB_ZCL_CLUSTER_SERVER_ROLE,
+                                 attr_id,
+                                 &v, false);
+    esp_zb_lock_release();
 }
 
-static inline void shs_ld2410_apply_no_one_duration(uint16_t seconds)
+static inline void shs_zb_set_u32_attr(uint8_t endpoint, uint16_t cluster, uint16_t attr_id, uint32_t value)
 {
-    shs_occupancy_clear_sec = seconds;
-    shs_ld2410_apply_params_all();
+    if (!shs_zb_ready) return;
+    uint32_t v = value;
+    esp_zb_lock_acquire(portMAX_DELAY);
+    esp_zb_zcl_set_attribute_val(endpoint,
+                                 cluster,
+                                 ESP_ZB_ZCL_CLUSTER_SERVER_ROLE,
+                                 attr_id,
+                                 &v, false);
+    esp_zb_lock_release();
 }
 
-/* ---------------- ZCL helpers ---------------- */
-static inline void shs_zb_set_occ_bitmap(uint8_t endpoint, bool occupied)
+static inline void shs_zb_set_u8_attr(uint8_t endpoint, uint16_t cluster, uint16_t attr_id, uint8_t value)
 {
     if (!shs_zb_ready) return;
-    uint8_t v = occupied ? 1 : 0; /* Occupancy (0x0000) is bitmap8; bit0=1 means occupied */
+    uint8_t v = value;
     esp_zb_lock_acquire(portMAX_DELAY);
     esp_zb_zcl_set_attribute_val(endpoint,
-                                 ESP_ZB_ZCL_CLUSTER_ID_OCCUPANCY_SENSING,
+                                 cluster,
                                  ESP_ZB_ZCL_CLUSTER_SERVER_ROLE,
-                                 ESP_ZB_ZCL_ATTR_OCCUPANCY_SENSING_OCCUPANCY_ID,
+                                 attr_id,
                                  &v, false);
     esp_zb_lock_release();
 }
 
-static inline void shs_zb_set_bool_attr(uint8_t endpoint, uint16_t cluster, uint16_t attr_id, bool value)
+static inline void shs_zb_set_u16_attr(uint8_t endpoint, uint16_t cluster, uint16_t attr_id, uint16_t value)
 {
     if (!shs_zb_ready) return;
-    bool v = value;
+    uint16_t v = value;
     esp_zb_lock_acquire(portMAX_DELAY);
     esp_zb_zcl_set_attribute_val(endpoint,
                                  cluster,
@@ -315,6 +480,166 @@ static inline void shs_zb_set_ou_delay_ep2(uint16_t seconds)
     esp_zb_lock_release();
 }
 
+/* Per-gate threshold write; false if attr_id is not a gate attribute of this driver */
+static bool shs_cfg_set_gate_thr(uint16_t attr_id, uint16_t v)
+{
+    if (!shs_radar_driver.per_gate_thr) return false;
+
+    uint16_t *tbl; uint16_t gate; const char *ch;
+    if (attr_id >= SHS_ATTR_MV_GATE_THR_BASE && attr_id <= SHS_ATTR_MV_GATE_THR_BASE + shs_radar_driver.max_gate) {
+        tbl = shs_mv_gate_thr; gate = attr_id - SHS_ATTR_MV_GATE_THR_BASE; ch = "Movement";
+    } else if (attr_id >= SHS_ATTR_ST_GATE_THR_BASE && attr_id <= SHS_ATTR_ST_GATE_THR_BASE + shs_radar_driver.max_gate) {
+        tbl = shs_st_gate_thr; gate = attr_id - SHS_ATTR_ST_GATE_THR_BASE; ch = "Occupancy";
+    } else {
+        return false;
+    }
+
+    if (v > 100) v = 100;
+    tbl[gate] = v;
+    shs_radar_cmd_enqueue(SHS_RADAR_CFG_GATE_THR);
+    shs_save_enqueue(SHS_SAVE_DEBOUNCE_GATE_THR, 0);
+    ESP_LOGI(SHS_TAG, "Set %s Gate %u Threshold = %u%s", ch, (unsigned)gate, (unsigned)v, v ? "" : " (global)");
+    return true;
+}
+
+/* Hold delay write; false if attr_id is not a hold attribute */
+static bool shs_cfg_set_hold(uint16_t attr_id, uint16_t v)
+{
+    const shs_hold_attr_t *a = shs_hold_attr_find(attr_id);
+    if (!a) return false;
+
+    if (v > a->max) v = a->max;
+    *a->val = v;
+    shs_save_enqueue(SHS_SAVE_IMMEDIATE_U16, (uint16_t)(attr_id << 8));
+    ESP_LOGI(SHS_TAG, "Set %s = %u%s", a->what, (unsigned)v, a->max == SHS_HOLD_ASSERT_MAX_MS ? "ms" : "s");
+    return true;
+}
+
+/* Zone field write; false if attr_id is not a zone attribute */
+static bool shs_cfg_set_zone(uint16_t attr_id, uint16_t v)
+{
+    if (!shs_radar_driver.has_distance) return false;
+    if (attr_id < SHS_ATTR_ZONE_BASE || attr_id >= SHS_ATTR_ZONE_BASE + SHS_ZONE_COUNT * SHS_ATTR_ZONE_STRIDE) return false;
+    size_t zone = (attr_id - SHS_ATTR_ZONE_BASE) / SHS_ATTR_ZONE_STRIDE;
+    uint16_t field = (attr_id - SHS_ATTR_ZONE_BASE) % SHS_ATTR_ZONE_STRIDE;
+    if (field > SHS_ZONE_FIELD_CLEAR_S) return false;
+
+    v = shs_cfg_set_zone_field(zone, field, v);
+    shs_radar_fp_invalidate(); /* re-evaluate zones on the next frame */
+    shs_save_enqueue(SHS_SAVE_DEBOUNCE_ZONES, 0);
+    static const char *const what[] = { "start", "end", "clear delay" };
+    ESP_LOGI(SHS_TAG, "Set Zone %u %s = %u%s", (unsigned)zone + 1, what[field], (unsigned)v,
+             field == SHS_ZONE_FIELD_CLEAR_S ? "s" : "cm");
+    return true;
+}
+
+/* ---------------- Empty-room calibration ----------------
+ * Samples per-gate energies for a window while the room is empty and sets
+ * each gate's threshold above its noise: max(peak, mean + SIGMAS*sd) + MARGIN.
+ * The radar task owns the accumulators; the handler and the BOOT button only
+ * post a request. Results go out through the per-gate threshold path. */
+typedef struct {
+    uint32_t sum[SHS_RADAR_MAX_GATES];
+    uint32_t sumsq[SHS_RADAR_MAX_GATES];
+    uint8_t  peak[SHS_RADAR_MAX_GATES];
+} shs_calib_acc_t;
+
+static int32_t         shs_calib_req = -1;      /* -1 none, 0 cancel, >0 start (window s) */
+static volatile bool   shs_calib_active = false;
+static uint32_t        shs_calib_start_ms, shs_calib_end_ms;
+static uint32_t        shs_calib_cnt[SHS_RADAR_MAX_GATES];
+static shs_calib_acc_t shs_calib_mv, shs_calib_st;
+
+static void shs_calib_request(uint16_t window_s)
+{
+    int32_t req = 0;
+    if (window_s > 0) {
+        req = window_s < SHS_CALIB_MIN_S ? SHS_CALIB_MIN_S : (window_s > SHS_CALIB_MAX_S ? SHS_CALIB_MAX_S : window_s);
+    }
+    __atomic_store_n(&shs_calib_req, req, __ATOMIC_SEQ_CST);
+}
+
+static void shs_calib_sample(const shs_radar_report_t *rpt)
+{
+    if (!shs_calib_active || rpt->n_gates == 0) return;
+    if (!shs_time_reached(esp_log_timestamp(), shs_calib_start_ms)) return;
+
+    for (uint8_t g = 0; g < rpt->n_gates && g < SHS_RADAR_MAX_GATES; ++g) {
+        uint8_t mv = rpt->mv_gate_energy[g], st = rpt->st_gate_energy[g];
+        shs_calib_mv.sum[g] += mv; shs_calib_mv.sumsq[g] += (uint32_t)mv * mv;
+        shs_calib_st.sum[g] += st; shs_calib_st.sumsq[g] += (uint32_t)st * st;
+        if (mv > shs_calib_mv.peak[g]) shs_calib_mv.peak[g] = mv;
+        if (st > shs_calib_st.peak[g]) shs_calib_st.peak[g] = st;
+        shs_calib_cnt[g]++;
+    }
+    shs_radar_fp_invalidate(); /* repeated frames are samples too */
+}
+
+static uint16_t shs_calib_threshold(const shs_calib_acc_t *a, uint8_t g, uint32_t n)
+{
+    uint32_t mean = (a->sum[g] + n / 2) / n;
+    uint64_t var  = ((uint64_t)a->sumsq[g] * n - (uint64_t)a->sum[g] * a->sum[g]) / ((uint64_t)n * n);
+    uint32_t thr  = mean + SHS_CALIB_SIGMAS * shs_isqrt((uint32_t)var);
+    if (a->peak[g] > thr) thr = a->peak[g];
+    thr += SHS_CALIB_MARGIN;
+    return (uint16_t)(thr > 100 ? 100 : thr); /* never 0: that would mean "global" */
+}
+
+static void shs_calib_finish(void)
+{
+    unsigned done = 0;
+    for (uint8_t g = 0; g <= shs_radar_driver.max_gate; ++g) {
+        uint32_t n = shs_calib_cnt[g];
+        if (n < SHS_CALIB_MIN_SAMPLES) continue;
+        shs_mv_gate_thr[g] = shs_calib_threshold(&shs_calib_mv, g, n);
+        shs_st_gate_thr[g] = shs_calib_threshold(&shs_calib_st, g, n);
+        shs_zb_set_u16_attr(SHS_EP_LIGHT, SHS_CL_CFG_ID, SHS_ATTR_MV_GATE_THR_BASE + g, shs_mv_gate_thr[g]);
+        shs_zb_set_u16_attr(SHS_EP_LIGHT, SHS_CL_CFG_ID, SHS_ATTR_ST_GATE_THR_BASE + g, shs_st_gate_thr[g]);
+        ESP_LOGI(SHS_TAG, "Calibrated gate %u: move peak=%u -> %u, static peak=%u -> %u (%u samples)",
+                 (unsigned)g, (unsigned)shs_calib_mv.peak[g], (unsigned)shs_mv_gate_thr[g],
+                 (unsigned)shs_calib_st.peak[g], (unsigned)shs_st_gate_thr[g], (unsigned)n);
+        done++;
+    }
+
+    if (done == 0) {
+        ESP_LOGW(SHS_TAG, "Calibration collected no per-gate energies, thresholds unchanged");
+        return;
+    }
+    shs_radar_cmd_enqueue(SHS_RADAR_CFG_GATE_THR);
+    shs_save_enqueue(SHS_SAVE_DEBOUNCE_GATE_THR, 0);
+    ESP_LOGI(SHS_TAG, "Calibration done: %u gate(s) updated", done);
+}
+
+/* Radar task: take a pending request and close the window when it ends */
+static void shs_calib_tick(uint32_t now_ms)
+{
+    int32_t req = __atomic_exchange_n(&shs_calib_req, -1, __ATOMIC_SEQ_CST);
+    if (req == 0 && shs_calib_active) {
+        shs_calib_active = false;
+        ESP_LOGI(SHS_TAG, "Calibration cancelled");
+    } else if (req > 0) {
+        memset(&shs_calib_mv, 0, sizeof(shs_calib_mv));
+        memset(&shs_calib_st, 0, sizeof(shs_calib_st));
+        memset(shs_calib_cnt, 0, sizeof(shs_calib_cnt));
+        shs_calib_start_ms = now_ms + SHS_CALIB_SETTLE_MS;
+        shs_calib_end_ms   = shs_calib_start_ms + (uint32_t)req * 1000U;
+        shs_calib_active   = true;
+        shs_calib_s        = (uint16_t)req;
+        shs_zb_set_u16_attr(SHS_EP_LIGHT, SHS_CL_CFG_ID, SHS_ATTR_CALIBRATE, shs_calib_s);
+        ESP_LOGI(SHS_TAG, "Calibration: leave the room, sampling starts in %us for %us",
+                 (unsigned)(SHS_CALIB_SETTLE_MS / 1000), (unsigned)req);
+    }
+
+    if (shs_calib_active && shs_time_reached(now_ms, shs_calib_end_ms)) {
+        shs_calib_active = false;
+        shs_calib_finish();
+    }
+    if (!shs_calib_active && shs_calib_s != 0) {
+        shs_calib_s = 0;
+        shs_zb_set_u16_attr(SHS_EP_LIGHT, SHS_CL_CFG_ID, SHS_ATTR_CALIBRATE, 0);
+    }
+}
+
 /* ---------------- ZCL write callback to config cluster + OnOff ---------------- */
 static esp_err_t shs_zb_attribute_handler(const esp_zb_zcl_set_attr_value_message_t *message)
 {
@@ -342,20 +667,14 @@ static esp_err_t shs_zb_attribute_handler(const esp_zb_zcl_set_attr_value_messag
         switch (message->attribute.id) {
             case SHS_ATTR_MOVEMENT_COOLDOWN: {
                 if (v > SHS_COOLDOWN_MAX_SEC) v = SHS_COOLDOWN_MAX_SEC;
-                bool was_zero = (shs_movement_cooldown_sec == 0);
-                shs_movement_cooldown_sec = v;
+                shs_movement_cooldown_sec = v; /* moving clear delay, taken at the next transition */
                 shs_save_enqueue(SHS_SAVE_IMMEDIATE_U16, (SHS_ATTR_MOVEMENT_COOLDOWN<<8)|0);
-                if (shs_movement_cooldown_sec == 0) {
-                    shs_mv_cooldown_active = false;
-                } else if (was_zero && shs_moving_state && !shs_mv_cooldown_active) {
-                    shs_mv_cooldown_active = true;
-                    shs_mv_cooldown_deadline_ms = esp_log_timestamp() + (uint32_t)shs_movement_cooldown_sec * 1000U;
-                }
                 ESP_LOGI(SHS_TAG, "Set Movement Clear Cooldown = %us", (unsigned)shs_movement_cooldown_sec);
                 return ESP_OK;
             }
             case SHS_ATTR_OCC_CLEAR_COOLDOWN: {
-                shs_ld2410_apply_no_one_duration(v);
+                shs_occupancy_clear_sec = v;
+                shs_radar_cmd_enqueue(SHS_RADAR_CFG_PARAMS);
                 shs_zb_set_ou_delay_ep2(shs_occupancy_clear_sec);
                 shs_save_enqueue(SHS_SAVE_IMMEDIATE_U16, (SHS_ATTR_OCC_CLEAR_COOLDOWN<<8)|0);
                 ESP_LOGI(SHS_TAG, "Set Occupancy Clear Cooldown = %us", (unsigned)shs_occupancy_clear_sec);
@@ -365,7 +684,7 @@ static esp_err_t shs_zb_attribute_handler(const esp_zb_zcl_set_attr_value_messag
                 if (v > 10) v = 10;
                 shs_sens_mv_0_10 = v;
                 shs_moving_sens_0_100 = (uint8_t)(v * 10);
-                shs_ld2410_apply_global_sensitivity(); 
+                shs_radar_cmd_enqueue(SHS_RADAR_CFG_SENS);
                 shs_save_enqueue(SHS_SAVE_DEBOUNCE_SENS_MOVE, shs_moving_sens_0_100); /* debounce NVS 500ms */
                 ESP_LOGI(SHS_TAG, "Set Movement Detection Sensitivity = %u/100", (unsigned)shs_moving_sens_0_100);
                 return ESP_OK;
@@ -374,28 +693,69 @@ static esp_err_t shs_zb_attribute_handler(const esp_zb_zcl_set_attr_value_messag
                 if (v > 10) v = 10;
                 shs_sens_st_0_10 = v;
                 shs_static_sens_0_100 = (uint8_t)(v * 10);
-                shs_ld2410_apply_global_sensitivity();
+                shs_radar_cmd_enqueue(SHS_RADAR_CFG_SENS);
                 shs_save_enqueue(SHS_SAVE_DEBOUNCE_SENS_STATIC, shs_static_sens_0_100);
                 ESP_LOGI(SHS_TAG, "Set Occupancy Detection Sensitivity = %u/100", (unsigned)shs_static_sens_0_100);
                 return ESP_OK;
             }
             case SHS_ATTR_MOVING_MAX_GATE: {
-                if (v > 8) v = 8;
+                if (v > shs_radar_driver.max_gate) v = shs_radar_driver.max_gate;
                 shs_moving_max_gate = v;
-                shs_ld2410_apply_params_all();
+                shs_radar_cmd_enqueue(SHS_RADAR_CFG_PARAMS);
                 shs_save_enqueue(SHS_SAVE_DEBOUNCE_GATE_MOVE, shs_moving_max_gate);
-                ESP_LOGI(SHS_TAG, "Set Movement Detection Range (gate) = %u", (unsigned)shs_moving_max_gate);
+                ESP_LOGI(SHS_TAG, "Set Movement Detection Range (gate) = %u (%ucm)",
+                         (unsigned)shs_moving_max_gate, (unsigned)shs_moving_max_gate * shs_gate_cm());
                 return ESP_OK;
             }
             case SHS_ATTR_STATIC_MAX_GATE: {
-                if (v < 2) v = 2; else if (v > 8) v = 8;
+                if (v < shs_radar_driver.min_static_gate) v = shs_radar_driver.min_static_gate;
+                else if (v > shs_radar_driver.max_gate) v = shs_radar_driver.max_gate;
                 shs_static_max_gate = v;
-                shs_ld2410_apply_params_all();
+                shs_radar_cmd_enqueue(SHS_RADAR_CFG_PARAMS);
                 shs_save_enqueue(SHS_SAVE_DEBOUNCE_GATE_STATIC, shs_static_max_gate);
-                ESP_LOGI(SHS_TAG, "Set Occupancy Detection Range (gate) = %u", (unsigned)shs_static_max_gate);
+                ESP_LOGI(SHS_TAG, "Set Occupancy Detection Range (gate) = %u (%ucm)",
+                         (unsigned)shs_static_max_gate, (unsigned)shs_static_max_gate * shs_gate_cm());
+                return ESP_OK;
+            }
+            case SHS_ATTR_CALIBRATE: {
+                if (!shs_radar_driver.per_gate_thr) break;
+                shs_calib_request(v);
+                ESP_LOGI(SHS_TAG, "Set Calibration = %us%s", (unsigned)v, v ? "" : " (cancel)");
+                return ESP_OK;
+            }
+            case SHS_ATTR_PRETRIGGER_CM: {
+                if (!shs_radar_driver.has_distance) break;
+                shs_pretrigger_cm = v;
+                shs_save_enqueue(SHS_SAVE_IMMEDIATE_U16, (SHS_ATTR_PRETRIGGER_CM<<8)|0);
+                ESP_LOGI(SHS_TAG, "Set Pre-trigger Distance = %ucm%s", (unsigned)v, v ? "" : " (off)");
+                return ESP_OK;
+            }
+            case SHS_ATTR_INTERF_SUPPRESS: {
+                shs_interf_enable = v ? 1 : 0;
+                shs_interf_reset_req = true;
+                shs_save_enqueue(SHS_SAVE_IMMEDIATE_U16, (SHS_ATTR_INTERF_SUPPRESS<<8)|0);
+                ESP_LOGI(SHS_TAG, "Set Interference Suppression = %s", shs_interf_enable ? "on" : "off");
+                return ESP_OK;
+            }
+            case SHS_ATTR_DIST_RESOLUTION: {
+                if (!shs_radar_driver.fine_res) break;
+                shs_dist_res = v ? 1 : 0;
+                shs_interf_reset_req = true; /* learned gates no longer line up */
+                /* gate indices are kept: the ranges shrink or grow with the gate size */
+                for (size_t z = 0; z < SHS_ZONE_COUNT; ++z) {
+                    (void)shs_cfg_set_zone_field(z, SHS_ZONE_FIELD_START_CM, shs_zones[z].start_cm);
+                    (void)shs_cfg_set_zone_field(z, SHS_ZONE_FIELD_END_CM,   shs_zones[z].end_cm);
+                }
+                shs_save_enqueue(SHS_SAVE_DEBOUNCE_ZONES, 0);
+                shs_radar_cmd_enqueue(SHS_RADAR_CFG_RES);
+                shs_save_enqueue(SHS_SAVE_IMMEDIATE_U16, (SHS_ATTR_DIST_RESOLUTION<<8)|0);
+                ESP_LOGI(SHS_TAG, "Set Distance Resolution = %ucm per gate", shs_gate_cm());
                 return ESP_OK;
             }
             default:
+                if (!shs_cfg_set_hold(message->attribute.id, v) && !shs_cfg_set_zone(message->attribute.id, v)) {
+                    (void)shs_cfg_set_gate_thr(message->attribute.id, v);
+                }
                 break;
         }
     }
@@ -410,147 +770,464 @@ static esp_err_t shs_zb_action_handler(esp_zb_core_action_callback_id_t callback
     return ESP_OK;
 }
 
-/* ---------------- Cooldown (moving) ---------------- */
-static inline void shs_mv_cooldown_tick(uint32_t now_ms)
+/* ---------------- Hold channels -> published states ----------------
+ * Moving, static and overall occupancy each pass through a hold channel
+ * (shs_hold.h) with their own assert and clear delays; a channel's output
+ * is what gets reported. */
+static void shs_hold_changed(shs_hold_t *h, bool state)
 {
-    if (shs_movement_cooldown_sec == 0 || !shs_mv_cooldown_active) return;
+    ESP_LOGI(SHS_TAG, "%s -> %s", h->name, state ? "DETECTED" : "CLEAR");
+    if (h == &shs_hold_mv) {
+        shs_moving_state = state;
+        shs_zb_set_bool_attr(SHS_EP_OCC, ESP_ZB_ZCL_CLUSTER_ID_OCCUPANCY_SENSING, SHS_ATTR_OCC_MOVING_TARGET, state);
+    } else if (h == &shs_hold_st) {
+        shs_static_state = state;
+        shs_zb_set_bool_attr(SHS_EP_OCC, ESP_ZB_ZCL_CLUSTER_ID_OCCUPANCY_SENSING, SHS_ATTR_OCC_STATIC_TARGET, state);
+    } else if (h == &shs_hold_occ) {
+        shs_occupancy_state = state;
+        shs_zb_set_occ_bitmap(SHS_EP_OCC, state);
+    } else {
+        size_t z = (size_t)(h - shs_hold_zone);
+        shs_zone_state[z] = state;
+        shs_zb_set_occ_bitmap(SHS_EP_ZONE_BASE + z, state);
+    }
+}
 
-    if (shs_time_reached(now_ms, shs_mv_cooldown_deadline_ms)) {
-        if (!shs_last_moving_sample) {
-            if (shs_moving_state) {
-                shs_moving_state = false;
-                ESP_LOGI(SHS_TAG, "Moving Target cooldown end -> CLEAR");
-                shs_zb_set_bool_attr(SHS_EP_OCC, ESP_ZB_ZCL_CLUSTER_ID_OCCUPANCY_SENSING, SHS_ATTR_OCC_MOVING_TARGET, false);
-            }
-            shs_mv_cooldown_active = false;
-        } else {
-            shs_mv_cooldown_deadline_ms = now_ms + (uint32_t)shs_movement_cooldown_sec * 1000U;
+/* Run the tracker on the last input and publish a direction change */
+static void shs_track_feed(uint32_t now_ms)
+{
+    shs_track_update(&shs_track, shs_track_has, shs_track_dist_cm, now_ms);
+    shs_track_step_ms = now_ms;
+
+    if (shs_track.dir != shs_target_dir) {
+        shs_target_dir = shs_track.dir;
+        ESP_LOGD(SHS_TAG, "Target dir %u: %ldcm %ldcm/s", shs_target_dir,
+                 (long)shs_track_range_cm(&shs_track), (long)shs_track_speed_cm_s(&shs_track));
+        shs_zb_set_u8_attr(SHS_EP_OCC, ESP_ZB_ZCL_CLUSTER_ID_OCCUPANCY_SENSING, SHS_ATTR_OCC_TARGET_DIR, shs_target_dir);
+    }
+}
+
+/* Track the nearest reported (non-zero) distance; an approaching target predicted inside the
+ * pre-trigger distance asserts occupancy without waiting for the assert delay */
+static void shs_track_step(const shs_radar_report_t *rpt, uint32_t now_ms)
+{
+    bool moving = (rpt->target_state & SHS_RADAR_STATE_MOVING) != 0;
+    bool stat   = (rpt->target_state & SHS_RADAR_STATE_STATIC) != 0;
+    uint16_t dist = 0;
+    if (moving && rpt->moving_dist_cm) dist = rpt->moving_dist_cm;
+    if (stat && rpt->static_dist_cm && (dist == 0 || rpt->static_dist_cm < dist)) dist = rpt->static_dist_cm;
+    shs_track_has     = moving || stat;
+    shs_track_dist_cm = dist;
+    shs_track_feed(now_ms);
+
+    if (shs_pretrigger_cm != 0 && !shs_hold_occ.out && shs_track.dir == SHS_TRACK_APPROACHING &&
+        shs_track_predict_cm(&shs_track, SHS_TRACK_LEAD_MS) <= shs_pretrigger_cm) {
+        ESP_LOGI(SHS_TAG, "Pre-trigger: target approaching at %ldcm/s, %ldcm",
+                 (long)-shs_track_speed_cm_s(&shs_track), (long)shs_track_range_cm(&shs_track));
+        shs_hold_trigger(&shs_hold_occ);
+    }
+}
+
+/* Repeated frames skip shs_track_step(): replay the last input so an unchanged
+ * target settles to stationary and a vanished one is dropped after
+ * SHS_TRACK_LOST_MS instead of keeping its last direction */
+static void shs_track_tick(uint32_t now_ms)
+{
+    if (!shs_radar_driver.has_distance || shs_link_stale) return;
+    if (!shs_track.valid && shs_target_dir == SHS_TRACK_NONE) return;
+    if (!shs_time_reached(now_ms, shs_track_step_ms + SHS_TRACK_REFEED_MS)) return;
+    shs_track_feed(now_ms);
+}
+
+/* Learn from every frame with gate energies; true if the moving target is only
+ * masked interferers and must be dropped */
+static bool shs_interf_step(const shs_radar_report_t *rpt)
+{
+    if (shs_interf_reset_req) {
+        shs_interf_reset_req = false;
+        shs_interf_reset(&shs_interf);
+        if (shs_interf_gates != 0) {
+            shs_interf_gates = 0;
+            shs_zb_set_u32_attr(SHS_EP_LIGHT, SHS_CL_CFG_ID, SHS_ATTR_DIAG_INTERF_GATES, 0);
         }
     }
+    if (!shs_interf_enable || rpt->n_gates == 0) return false;
+
+    uint8_t thr[SHS_RADAR_MAX_GATES];
+    for (uint8_t g = 0; g < rpt->n_gates && g < SHS_RADAR_MAX_GATES; ++g) {
+        thr[g] = (uint8_t)(shs_mv_gate_thr[g] ? shs_mv_gate_thr[g] : shs_moving_sens_0_100);
+    }
+    bool motion = shs_interf_update(&shs_interf, rpt->mv_gate_energy, thr, rpt->n_gates, rpt->mv_max_gate);
+    if (shs_interf.masked != shs_interf_gates) {
+        shs_interf_gates = shs_interf.masked;
+        shs_zb_set_u32_attr(SHS_EP_LIGHT, SHS_CL_CFG_ID, SHS_ATTR_DIAG_INTERF_GATES, shs_interf_gates);
+    }
+    /* with nothing masked the module's own decision stands */
+    return shs_interf.masked != 0 && !motion && (rpt->target_state & SHS_RADAR_STATE_MOVING);
 }
 
-/* ---------------- UART task: LD2410 live frames ---------------- */
-static void shs_process_sensor_state(uint8_t state_byte)
+/* Publish only steps of SHS_CONF_REPORT_CHANGE, the ends of the scale, and 50 crossings */
+static void shs_confidence_publish(uint8_t v)
 {
-    bool moving   = (state_byte & 0x01) != 0;
-    bool stat     = (state_byte & 0x02) != 0;
-    bool presence = (state_byte & 0x03) != 0;
+    int d = (int)v - (int)shs_confidence;
+    bool crossed = (v >= 50) != (shs_confidence >= 50);
+    if (d == 0 || (!crossed && d < SHS_CONF_REPORT_CHANGE && d > -SHS_CONF_REPORT_CHANGE && v != 0 && v != 100)) return;
+    shs_confidence = v;
+    shs_zb_set_u8_attr(SHS_EP_OCC, ESP_ZB_ZCL_CLUSTER_ID_OCCUPANCY_SENSING, SHS_ATTR_OCC_CONFIDENCE, v);
+}
 
-    shs_last_moving_sample = moving;
+/* Energy vs threshold on a 0..100 scale: 0 -> 0, threshold -> 50, 100 -> 100 */
+static uint8_t shs_conf_margin(uint8_t e, uint8_t thr)
+{
+    if (e > 100) e = 100;
+    if (e >= thr) return (uint8_t)(thr >= 100 ? 100 : 50 + (50U * (e - thr)) / (100U - thr));
+    return (uint8_t)((50U * e) / thr);
+}
 
-    if (shs_movement_cooldown_sec == 0) {
-        if (moving != shs_moving_state) {
-            shs_moving_state = moving;
-            ESP_LOGI(SHS_TAG, "Moving Target -> %s", moving ? "DETECTED" : "CLEAR");
-            shs_zb_set_bool_attr(SHS_EP_OCC, ESP_ZB_ZCL_CLUSTER_ID_OCCUPANCY_SENSING, SHS_ATTR_OCC_MOVING_TARGET, moving);
+/* Best margin over the gates in range (masked interferers only above their
+ * ceiling), or the frame's summary energies when it carries no gates. The
+ * module's own target flag decides which side of 50 the value sits on.
+ * Only scores new frames; shs_confidence_tick() smooths it in. */
+static void shs_confidence_step(const shs_radar_report_t *rpt, bool present)
+{
+    uint8_t raw = 0;
+    if (rpt->n_gates > 0) {
+        for (uint8_t g = 0; g < rpt->n_gates && g < SHS_RADAR_MAX_GATES; ++g) {
+            uint8_t mv_thr = (uint8_t)(shs_mv_gate_thr[g] ? shs_mv_gate_thr[g] : shs_moving_sens_0_100);
+            uint8_t st_thr = (uint8_t)(shs_st_gate_thr[g] ? shs_st_gate_thr[g] : shs_static_sens_0_100);
+            bool masked = (shs_interf.masked & (1UL << g)) && rpt->mv_gate_energy[g] <= shs_interf.ceiling[g];
+            uint8_t m = (g <= shs_moving_max_gate && !masked) ? shs_conf_margin(rpt->mv_gate_energy[g], mv_thr) : 0;
+            uint8_t s = (g <= shs_static_max_gate) ? shs_conf_margin(rpt->st_gate_energy[g], st_thr) : 0;
+            if (m > raw) raw = m;
+            if (s > raw) raw = s;
         }
     } else {
-        uint32_t now = esp_log_timestamp();
-        if (!shs_mv_cooldown_active) {
-            if (moving && !shs_moving_state) {
-                shs_moving_state = true;
-                ESP_LOGI(SHS_TAG, "Moving Target START -> DETECTED (cooldown %us)", (unsigned)shs_movement_cooldown_sec);
-                shs_zb_set_bool_attr(SHS_EP_OCC, ESP_ZB_ZCL_CLUSTER_ID_OCCUPANCY_SENSING, SHS_ATTR_OCC_MOVING_TARGET, true);
-                shs_mv_cooldown_active = true;
-                shs_mv_cooldown_deadline_ms = now + (uint32_t)shs_movement_cooldown_sec * 1000U;
-            }
-        } else {
-            shs_mv_cooldown_tick(now);
+        uint8_t m = (rpt->target_state & SHS_RADAR_STATE_MOVING) ? shs_conf_margin(rpt->moving_energy, shs_moving_sens_0_100) : 0;
+        uint8_t s = (rpt->target_state & SHS_RADAR_STATE_STATIC) ? shs_conf_margin(rpt->static_energy, shs_static_sens_0_100) : 0;
+        raw = m > s ? m : s;
+    }
+    if (present && raw < 50) raw = 50;
+    else if (!present && raw > 49) raw = 49;
+    shs_conf_raw = raw;
+}
+
+/* One EMA step (Q8) per good frame, duplicates included: the parsers drop
+ * repeated payloads before shs_process_sensor_state(), and a steady report
+ * must still settle on its score. Rising, q stops within 1/8 LSB below the
+ * target and rounds onto it, so a present target reaches 50. */
+static void shs_confidence_tick(void)
+{
+    uint32_t n = shs_radar_stats.good_frames - shs_conf_frames;
+    shs_conf_frames = shs_radar_stats.good_frames;
+    if (n == 0 || shs_link_stale) return;
+    if (n > SHS_CONF_MAX_STEPS) n = SHS_CONF_MAX_STEPS;
+
+    int32_t q = shs_conf_q8;
+    while (n--) q += (((int32_t)shs_conf_raw << 8) - q) >> SHS_CONF_SMOOTH_SHIFT;
+    shs_conf_q8 = (uint16_t)q;
+    shs_confidence_publish((uint8_t)((q + 128) >> 8));
+}
+
+/* A zone is occupied while the moving or static target's distance lies inside it */
+static void shs_zones_eval(const shs_radar_report_t *rpt)
+{
+    bool moving = (rpt->target_state & SHS_RADAR_STATE_MOVING) != 0;
+    bool stat   = (rpt->target_state & SHS_RADAR_STATE_STATIC) != 0;
+    for (size_t z = 0; z < SHS_ZONE_COUNT; ++z) {
+        const shs_zone_cfg_t *zc = &shs_zones[z];
+        bool in = zc->end_cm != 0 && zc->start_cm <= zc->end_cm &&
+                  ((moving && rpt->moving_dist_cm >= zc->start_cm && rpt->moving_dist_cm <= zc->end_cm) ||
+                   (stat   && rpt->static_dist_cm >= zc->start_cm && rpt->static_dist_cm <= zc->end_cm));
+        shs_hold_input(&shs_hold_zone[z], in);
+    }
+}
+
+/* ---------------- Radar reports -> presence ----------------
+ * Occupancy is the last frame's targets or the OUT pin. The pin answers
+ * first (edge interrupt), frames refine it into moving/static, and while
+ * the UART link is silent occupancy follows the pin alone. */
+static void shs_occupancy_eval(const char *src)
+{
+    bool presence = (shs_frame_presence && !shs_link_stale) || shs_radar_out_level();
+    if (presence) shs_presence_ms = esp_log_timestamp();
+    if (presence != shs_hold_occ.in) ESP_LOGD(SHS_TAG, "Occupancy input -> %u (%s)", presence, src);
+    shs_hold_input(&shs_hold_occ, presence);
+}
+
+static void shs_out_pin_changed(void)
+{
+    shs_occupancy_eval("OUT pin");
+}
+
+/* A silent link must not freeze the last targets: once stale they are cleared
+ * and occupancy follows the OUT pin (clear if not wired) until frames return */
+static void shs_link_tick(uint32_t now_ms)
+{
+    if (shs_radar_stats.good_frames != shs_link_frames) {
+        shs_link_frames = shs_radar_stats.good_frames;
+        shs_link_alive_ms = now_ms;
+        if (shs_link_stale) {
+            shs_link_stale = false;
+            ESP_LOGI(SHS_TAG, "Radar frames back");
         }
+    } else if (!shs_link_stale && shs_time_reached(now_ms, shs_link_alive_ms + SHS_RADAR_LINK_STALE_MS)) {
+        shs_link_stale = true;
+        shs_radar_stats.link_losses++;
+        ESP_LOGW(SHS_TAG, "No radar frames for %ums, clearing targets", (unsigned)SHS_RADAR_LINK_STALE_MS);
+
+        /* targets were not seen leaving: drop them without a clear delay */
+        shs_hold_force(&shs_hold_mv, false);
+        shs_hold_force(&shs_hold_st, false);
+        for (size_t z = 0; z < SHS_ZONE_COUNT; ++z) shs_hold_force(&shs_hold_zone[z], false);
+        shs_track_reset(&shs_track);
+        shs_conf_q8 = 0;
+        shs_conf_raw = 0;
+        shs_confidence_publish(0);
+        if (shs_target_dir != SHS_TRACK_NONE) {
+            shs_target_dir = SHS_TRACK_NONE;
+            shs_zb_set_u8_attr(SHS_EP_OCC, ESP_ZB_ZCL_CLUSTER_ID_OCCUPANCY_SENSING, SHS_ATTR_OCC_TARGET_DIR, shs_target_dir);
+        }
+        shs_radar_fp_invalidate(); /* the first frame back must be processed even if unchanged */
     }
+    shs_occupancy_eval(shs_link_stale ? "link lost" : "OUT pin");
+}
 
-    if (stat != shs_static_state) {
-        shs_static_state = stat;
-        ESP_LOGI(SHS_TAG, "Static Target -> %s", stat ? "DETECTED" : "CLEAR");
-        shs_zb_set_bool_attr(SHS_EP_OCC, ESP_ZB_ZCL_CLUSTER_ID_OCCUPANCY_SENSING, SHS_ATTR_OCC_STATIC_TARGET, stat);
+static void shs_process_sensor_state(const shs_radar_report_t *rpt)
+{
+    bool moving   = (rpt->target_state & SHS_RADAR_STATE_MOVING) != 0;
+    bool stat     = (rpt->target_state & SHS_RADAR_STATE_STATIC) != 0;
+    bool presence = moving || stat;
+
+    ESP_LOGD(SHS_TAG, "Report: state=0x%02x mv=%ucm/%u st=%ucm/%u det=%ucm",
+             rpt->target_state,
+             (unsigned)rpt->moving_dist_cm, (unsigned)rpt->moving_energy,
+             (unsigned)rpt->static_dist_cm, (unsigned)rpt->static_energy,
+             (unsigned)rpt->detect_dist_cm);
+    if (rpt->n_gates > 0) {
+        char mv[SHS_RADAR_MAX_GATES * 4 + 1], st[SHS_RADAR_MAX_GATES * 4 + 1];
+        int mo = 0, so = 0;
+        for (uint8_t g = 0; g < rpt->n_gates; ++g) {
+            mo += snprintf(mv + mo, sizeof(mv) - mo, " %u", rpt->mv_gate_energy[g]);
+            so += snprintf(st + so, sizeof(st) - so, " %u", rpt->st_gate_energy[g]);
+        }
+        ESP_LOGD(SHS_TAG, "Gates mv:%s", mv);
+        ESP_LOGD(SHS_TAG, "Gates st:%s", st);
+    }
+
+    shs_calib_sample(rpt);
+
+    shs_radar_report_t filtered;
+    if (shs_interf_step(rpt)) {
+        filtered = *rpt;
+        filtered.target_state &= (uint8_t)~SHS_RADAR_STATE_MOVING;
+        rpt = &filtered;
+        moving = false;
+        presence = stat;
+        shs_interf_suppressed++;
     }
 
-    if (presence != shs_occupancy_state) {
-        shs_occupancy_state = presence;
-        ESP_LOGI(SHS_TAG, "Occupancy -> %s", presence ? "DETECTED" : "CLEAR");
-        shs_zb_set_occ_bitmap(SHS_EP_OCC, presence);
+    shs_hold_input(&shs_hold_mv, moving);
+    shs_hold_input(&shs_hold_st, stat);
+    if (shs_radar_driver.has_distance) {
+        shs_zones_eval(rpt);
+        shs_track_step(rpt, esp_log_timestamp());
     }
+    shs_confidence_step(rpt, presence);
+
+    shs_frame_presence = presence;
+    shs_occupancy_eval("frame");
 }
 
-static void shs_ld2410_task(void *pvParameters)
+/* Push parser counters to the EP1 diagnostic attributes (rate-limited) */
+static void shs_radar_stats_publish_tick(uint32_t now_ms)
 {
-    uint8_t rxbuf[SHS_UART_BUF_SIZE];
-    static uint8_t acc[SHS_UART_ACC_BUF_SIZE];
-    size_t start = 0, acc_len = 0;
+    static uint32_t next_ms = 0;
+    if (!shs_time_reached(now_ms, next_ms)) return;
+    next_ms = now_ms + SHS_DIAG_PUBLISH_MS;
+
+    shs_zb_set_u32_attr(SHS_EP_LIGHT, SHS_CL_CFG_ID, SHS_ATTR_DIAG_GOOD_FRAMES,   shs_radar_stats.good_frames);
+    shs_zb_set_u32_attr(SHS_EP_LIGHT, SHS_CL_CFG_ID, SHS_ATTR_DIAG_BAD_FRAMES,    shs_radar_stats.bad_frames);
+    shs_zb_set_u32_attr(SHS_EP_LIGHT, SHS_CL_CFG_ID, SHS_ATTR_DIAG_RESYNCS,       shs_radar_stats.resyncs);
+    shs_zb_set_u32_attr(SHS_EP_LIGHT, SHS_CL_CFG_ID, SHS_ATTR_DIAG_DROPPED_BYTES, shs_radar_stats.dropped_bytes);
+    shs_zb_set_u32_attr(SHS_EP_LIGHT, SHS_CL_CFG_ID, SHS_ATTR_DIAG_DUP_FRAMES,    shs_radar_stats.duplicate_frames);
+    shs_zb_set_u32_attr(SHS_EP_LIGHT, SHS_CL_CFG_ID, SHS_ATTR_DIAG_CMD_FAILURES,  shs_radar_stats.cmd_failures);
+    shs_zb_set_u32_attr(SHS_EP_LIGHT, SHS_CL_CFG_ID, SHS_ATTR_DIAG_CMD_RETRIES,   shs_radar_stats.cmd_retries);
+    shs_zb_set_u32_attr(SHS_EP_LIGHT, SHS_CL_CFG_ID, SHS_ATTR_DIAG_CMD_RTT_MAX_MS, shs_radar_stats.cmd_rtt_max_ms);
+    shs_zb_set_u32_attr(SHS_EP_LIGHT, SHS_CL_CFG_ID, SHS_ATTR_DIAG_LINK_LOSSES,   shs_radar_stats.link_losses);
+    shs_zb_set_u32_attr(SHS_EP_LIGHT, SHS_CL_CFG_ID, SHS_ATTR_DIAG_LINK_RECOVERIES, shs_radar_stats.link_recoveries);
+    shs_zb_set_u32_attr(SHS_EP_LIGHT, SHS_CL_CFG_ID, SHS_ATTR_DIAG_DRIFT_EVENTS,  shs_radar_stats.drift_events);
+    shs_zb_set_u32_attr(SHS_EP_LIGHT, SHS_CL_CFG_ID, SHS_ATTR_DIAG_INTERF_SUPPRESSED, shs_interf_suppressed);
+
+    size_t n;
+    const shs_radar_cmd_stat_t *cs = shs_radar_cmd_stats(&n);
+    for (size_t i = 0; i < n; ++i) {
+        ESP_LOGD(SHS_TAG, "cmd 0x%04x: ok=%u failed=%u rtt last=%ums max=%ums",
+                 cs[i].cmd, (unsigned)cs[i].ok, (unsigned)cs[i].failed, cs[i].last_ms, cs[i].max_ms);
+    }
+}
 
+static void shs_radar_task(void *pvParameters)
+{
+    shs_link_alive_ms = esp_log_timestamp();
     for (;;) {
-        int len = uart_read_bytes(SHS_LD2410_UART_NUM, rxbuf, sizeof(rxbuf), 20 / portTICK_PERIOD_MS);
-        if (len > 0) {
-            if (start + acc_len + (size_t)len > sizeof(acc)) {
-                if (acc_len > 0) memmove(acc, acc + start, acc_len);
-                start = 0;
-            }
-            size_t copy = (size_t)len;
-            if (start + acc_len + copy > sizeof(acc)) {
-                size_t free_space = sizeof(acc) - (start + acc_len);
-                memcpy(acc + start + acc_len, rxbuf, free_space);
-                acc_len += free_space;
-            } else {
-                memcpy(acc + start + acc_len, rxbuf, copy);
-                acc_len += copy;
-            }
+        /* hold deadlines wake the poll through shs_radar_wake() */
+        shs_radar_poll(pdMS_TO_TICKS(SHS_RADAR_IDLE_WAIT_MS), shs_process_sensor_state);
 
-            size_t i = 0;
-            while (acc_len - i >= SHS_LD2410_MIN_FRAME_BYTES) {
-                size_t h = i;
-                for (; h + 4 <= acc_len; ++h) {
-                    if (acc[start + h]     == SHS_LD2410_HDR_RX0 &&
-                        acc[start + h + 1] == SHS_LD2410_HDR_RX1 &&
-                        acc[start + h + 2] == SHS_LD2410_HDR_RX2 &&
-                        acc[start + h + 3] == SHS_LD2410_HDR_RX3) {
-                        break;
-                    }
-                }
-                if (h + SHS_LD2410_MIN_FRAME_BYTES > acc_len) { i = h; break; }
-                if (h >= acc_len) { i = acc_len; break; }
-
-                bool consumed = false;
-                if (acc_len - h >= 10) {
-                    uint16_t le_len = (uint16_t)acc[start + h + 4] | ((uint16_t)acc[start + h + 5] << 8);
-                    size_t total = 4 + 2 + (size_t)le_len + 4;
-                    if (h + total <= acc_len) {
-                        if (acc[start + h + total - 4] == SHS_LD2410_TAIL_RX0 &&
-                            acc[start + h + total - 3] == SHS_LD2410_TAIL_RX1 &&
-                            acc[start + h + total - 2] == SHS_LD2410_TAIL_RX2 &&
-                            acc[start + h + total - 1] == SHS_LD2410_TAIL_RX3) {
-
-                            shs_process_sensor_state(acc[start + h + 8]);
-
-                            size_t drop = h + total;
-                            start += drop;
-                            acc_len -= drop;
-                            i = 0;
-                            consumed = true;
-                        }
-                    }
-                }
+        uint32_t now = esp_log_timestamp();
+        shs_hold_tick(&shs_hold_mv);
+        shs_hold_tick(&shs_hold_st);
+        shs_hold_tick(&shs_hold_occ);
+        for (size_t z = 0; z < SHS_ZONE_COUNT; ++z) shs_hold_tick(&shs_hold_zone[z]);
+        shs_link_tick(now);
+        shs_track_tick(now);
+        shs_confidence_tick();
+        shs_calib_tick(now);
+        shs_radar_stats_publish_tick(now);
+    }
+}
 
-                if (!consumed) {
-                    shs_process_sensor_state(acc[start + h + 8]);
+/* ---------------- Link watchdog (command worker) ----------------
+ * While the radar task reports the link stale, escalate one step per
+ * SHS_RADAR_WD_STEP_MS: end config, module restart, re-init + full re-apply
+ * of the stored settings. After that the link is reported down and the
+ * restart / re-apply pair is retried every SHS_RADAR_WD_RETRY_MS. */
+static void shs_link_set_state(uint32_t st)
+{
+    if (st == shs_link_state) return;
+    shs_link_state = st;
+    shs_zb_set_u32_attr(SHS_EP_LIGHT, SHS_CL_CFG_ID, SHS_ATTR_DIAG_LINK_STATE, st);
+    shs_zb_set_u32_attr(SHS_EP_LIGHT, SHS_CL_CFG_ID, SHS_ATTR_DIAG_LINK_LOSSES, shs_radar_stats.link_losses);
+    shs_zb_set_u32_attr(SHS_EP_LIGHT, SHS_CL_CFG_ID, SHS_ATTR_DIAG_LINK_RECOVERIES, shs_radar_stats.link_recoveries);
+}
 
-                    size_t drop = h + SHS_LD2410_MIN_FRAME_BYTES;
-                    start += drop;
-                    acc_len -= drop;
-                    i = 0;
-                }
-            }
-        }
+static void shs_link_watchdog(void)
+{
+    static uint8_t  step = 0;
+    static uint32_t next_ms = 0;
+    uint32_t now = esp_log_timestamp();
+
+    if (!shs_link_stale) {
+        if (step != 0) ESP_LOGI(SHS_TAG, "Radar link recovered (watchdog step %u)", (unsigned)step);
+        step = 0;
+        shs_link_set_state(SHS_LINK_UP);
+        return;
+    }
+    if (step == 0) {
+        step = SHS_RADAR_RECOVER_END_CONFIG;
+        next_ms = now;
+        if (shs_link_state == SHS_LINK_UP) shs_link_set_state(SHS_LINK_RECOVERING);
+    }
+    if (!shs_time_reached(now, next_ms)) return;
+
+    shs_radar_stats.link_recoveries++;
+    if (step <= SHS_RADAR_RECOVER_RESTART) {
+        if (shs_radar_driver.recover) (void)shs_radar_driver.recover(step);
+        step++;
+        next_ms = esp_log_timestamp() + SHS_RADAR_WD_STEP_MS;
+        return;
+    }
 
-        shs_mv_cooldown_tick(esp_log_timestamp());
+    ESP_LOGW(SHS_TAG, "Recovery: re-init radar and re-apply settings");
+    shs_radar_driver.init();
+    (void)shs_radar_apply(SHS_RADAR_CFG_ALL);
+    if (shs_link_stale) {
+        ESP_LOGE(SHS_TAG, "Radar link down, retrying in %us", (unsigned)(SHS_RADAR_WD_RETRY_MS / 1000));
+        shs_link_set_state(SHS_LINK_DOWN);
     }
+    step = SHS_RADAR_RECOVER_RESTART;
+    next_ms = esp_log_timestamp() + SHS_RADAR_WD_RETRY_MS;
 }
 
-/* ---------------- BOOT button (factory reset) ---------------- */
+/* ---------------- Config drift check (command worker) ----------------
+ * Every SHS_RADAR_DRIFT_CHECK_MS the driver reads the module back. A
+ * read-back session pauses the report stream, so the check is held off
+ * while anyone is present (or was within SHS_RADAR_DRIFT_QUIET_MS) and
+ * during calibration. On drift the stored settings are re-applied; the
+ * driver compares against the fresh read-back and rewrites only what differs. */
+static void shs_drift_tick(void)
+{
+    static uint32_t next_ms = SHS_RADAR_DRIFT_CHECK_MS;
+    uint32_t now = esp_log_timestamp();
+
+    if (!shs_radar_driver.verify || shs_link_stale) return;
+    if (!shs_time_reached(now, next_ms)) return;
+    if (shs_occupancy_state || shs_calib_active ||
+        !shs_time_reached(now, shs_presence_ms + SHS_RADAR_DRIFT_QUIET_MS)) return;
+    next_ms = now + SHS_RADAR_DRIFT_CHECK_MS;
+
+    bool drift = false;
+    esp_err_t err = shs_radar_driver.verify(&drift);
+    if (err != ESP_OK) {
+        ESP_LOGW(SHS_TAG, "Drift check: read-back failed (%s)", esp_err_to_name(err));
+        return;
+    }
+
+    /* the shadow now holds what the module reports: the diffed apply writes
+     * exactly the fields that disagree with the stored config */
+    uint32_t sent = shs_radar_cmd_count();
+    (void)shs_radar_apply(SHS_RADAR_CFG_ALL);
+    if (shs_radar_cmd_count() != sent) drift = true;
+
+    if (!drift) {
+        ESP_LOGD(SHS_TAG, "Drift check: module config matches");
+        return;
+    }
+    shs_radar_stats.drift_events++;
+    ESP_LOGW(SHS_TAG, "Drift check: module config differed, re-applied (%u so far)",
+             (unsigned)shs_radar_stats.drift_events);
+    shs_zb_set_u32_attr(SHS_EP_LIGHT, SHS_CL_CFG_ID, SHS_ATTR_DIAG_DRIFT_EVENTS, shs_radar_stats.drift_events);
+}
+
+/* ---------------- Radar command worker task ---------------- */
+static void shs_radar_cmd_worker(void *pv)
+{
+    /* Find the module's rate (and optionally raise it); nothing else reads RX yet */
+    bool upgrade = shs_radar_driver.upgrade_baud != 0 && shs_radar_baud_noup != shs_radar_driver.upgrade_baud;
+    uint32_t locked = shs_radar_baud_negotiate(shs_radar_baud, &upgrade);
+    if (locked != 0 && locked != shs_radar_baud) {
+        shs_radar_baud = locked;
+        shs_cfg_save_u32(SHS_NVS_KEY_BAUD, locked);
+    }
+    /* a refused switch costs a module restart: remember it, forget it once the rate works */
+    uint32_t noup = upgrade ? 0 : shs_radar_driver.upgrade_baud;
+    if (locked != 0 && noup != shs_radar_baud_noup) {
+        shs_radar_baud_noup = noup;
+        shs_cfg_save_u32(SHS_NVS_KEY_BAUD_NOUP, noup);
+    }
+
+    /* RX task next: command ACKs are parsed there while init/apply wait for them */
+    xTaskCreate(shs_radar_task, "shs_radar_task", 4096, NULL, 6, NULL);
+    shs_radar_driver.init();
+    if (shs_radar_apply(SHS_RADAR_CFG_ALL) != ESP_OK) {
+        ESP_LOGW(SHS_TAG, "Radar settings not fully applied at boot");
+    }
+
+    uint32_t what, more;
+    for (;;) {
+        shs_link_watchdog();
+        shs_drift_tick();
+        if (!xQueueReceive(shs_radar_cmd_q, &what, pdMS_TO_TICKS(SHS_RADAR_WD_CHECK_MS))) continue;
+
+        /* merge everything queued within the window; the driver sends only what differs */
+        TickType_t t0 = xTaskGetTickCount();
+        TickType_t window = pdMS_TO_TICKS(SHS_RADAR_CMD_COALESCE_MS);
+        TickType_t spent;
+        while ((spent = xTaskGetTickCount() - t0) < window &&
+               xQueueReceive(shs_radar_cmd_q, &more, window - spent)) {
+            what |= more;
+        }
+        (void)shs_radar_apply(what);
+    }
+}
+
+/* ---------------- BOOT button (factory reset, calibration gesture) ---------------- */
 static void shs_boot_button_task(void *pv)
 {
     const TickType_t poll = pdMS_TO_TICKS(25);
     const uint32_t required_ticks = SHS_FACTORY_RESET_LONGPRESS_MS / 25;
+    const uint32_t short_ticks = SHS_CALIB_GESTURE_PRESS_MAX_MS / 25;
     uint32_t held = 0; bool armed = false;
+    uint32_t presses = 0, gesture_deadline_ms = 0;
 
     gpio_config_t io = {
         .pin_bit_mask = 1ULL << SHS_BOOT_BUTTON_GPIO,
@@ -563,19 +1240,37 @@ static void shs_boot_button_task(void *pv)
 
     ESP_LOGI(SHS_TAG, "BOOT long-press enabled on GPIO%d (hold %u ms to factory reset Zigbee and rejoin)",
              SHS_BOOT_BUTTON_GPIO, (unsigned)SHS_FACTORY_RESET_LONGPRESS_MS);
+    if (shs_radar_driver.per_gate_thr) {
+        ESP_LOGI(SHS_TAG, "BOOT %ux short press starts an empty-room calibration", (unsigned)SHS_CALIB_GESTURE_PRESSES);
+    }
 
     while (1) {
         int level = gpio_get_level(SHS_BOOT_BUTTON_GPIO); /* BOOT pulls to GND when pressed */
         if (level == 0) {
             if (held < required_ticks) held++;
-            if (!armed && held > 4) { armed = true; ESP_LOGI(SHS_TAG, "BOOT press detected, hold to confirm..."); }
+            if (!armed && held > short_ticks) { armed = true; ESP_LOGI(SHS_TAG, "BOOT press detected, hold to confirm..."); }
             if (held >= required_ticks) {
                 ESP_LOGW(SHS_TAG, "BOOT long-press confirmed: factory resetting Zigbee state...");
                 esp_zb_factory_reset();
                 vTaskDelay(pdMS_TO_TICKS(100));
                 esp_restart();
             }
-        } else { held = 0; armed = false; }
+        } else {
+            /* a run of short presses starts an empty-room calibration */
+            if (held >= 2 && held <= short_ticks && shs_radar_driver.per_gate_thr) {
+                uint32_t now = esp_log_timestamp();
+                if (presses == 0 || shs_time_reached(now, gesture_deadline_ms)) {
+                    presses = 0;
+                    gesture_deadline_ms = now + SHS_CALIB_GESTURE_WINDOW_MS;
+                }
+                if (++presses >= SHS_CALIB_GESTURE_PRESSES) {
+                    presses = 0;
+                    ESP_LOGI(SHS_TAG, "BOOT gesture: empty-room calibration");
+                    shs_calib_request(SHS_CALIB_DEFAULT_S);
+                }
+            }
+            held = 0; armed = false;
+        }
         vTaskDelay(poll);
     }
 }
@@ -644,6 +1339,11 @@ void esp_zb_app_signal_handler(esp_zb_app_signal_t *signal_struct)
             shs_zb_set_bool_attr(SHS_EP_OCC, ESP_ZB_ZCL_CLUSTER_ID_OCCUPANCY_SENSING, SHS_ATTR_OCC_MOVING_TARGET, shs_moving_state);
             shs_zb_set_bool_attr(SHS_EP_OCC, ESP_ZB_ZCL_CLUSTER_ID_OCCUPANCY_SENSING, SHS_ATTR_OCC_STATIC_TARGET, shs_static_state);
             shs_zb_set_occ_bitmap(SHS_EP_OCC, shs_occupancy_state);
+            if (shs_radar_driver.has_distance) {
+                for (size_t z = 0; z < SHS_ZONE_COUNT; ++z) shs_zb_set_occ_bitmap(SHS_EP_ZONE_BASE + z, shs_zone_state[z]);
+                shs_zb_set_u8_attr(SHS_EP_OCC, ESP_ZB_ZCL_CLUSTER_ID_OCCUPANCY_SENSING, SHS_ATTR_OCC_TARGET_DIR, shs_target_dir);
+            }
+            shs_zb_set_u8_attr(SHS_EP_OCC, ESP_ZB_ZCL_CLUSTER_ID_OCCUPANCY_SENSING, SHS_ATTR_OCC_CONFIDENCE, shs_confidence);
 
             ESP_LOGI(SHS_TAG, "Device started up in%s factory-reset mode", esp_zb_bdb_is_factory_new() ? "" : " non");
             if (esp_zb_bdb_is_factory_new()) {
@@ -728,6 +1428,103 @@ static void shs_zigbee_task(void *pvParameters)
                                               ESP_ZB_ZCL_ATTR_TYPE_U16, ESP_ZB_ZCL_ATTR_ACCESS_READ_WRITE,
                                               &shs_static_max_gate);
 
+        esp_zb_custom_cluster_add_custom_attr(cfg_cl, SHS_ATTR_INTERF_SUPPRESS,
+                                              ESP_ZB_ZCL_ATTR_TYPE_U16, ESP_ZB_ZCL_ATTR_ACCESS_READ_WRITE,
+                                              &shs_interf_enable);
+
+        /* Distance settings only for drivers that report distances */
+        if (shs_radar_driver.has_distance) {
+            esp_zb_custom_cluster_add_custom_attr(cfg_cl, SHS_ATTR_PRETRIGGER_CM,
+                                                  ESP_ZB_ZCL_ATTR_TYPE_U16, ESP_ZB_ZCL_ATTR_ACCESS_READ_WRITE,
+                                                  &shs_pretrigger_cm);
+        }
+        for (size_t z = 0; z < SHS_ZONE_COUNT && shs_radar_driver.has_distance; ++z) {
+            const uint16_t base = SHS_ATTR_ZONE_BASE + z * SHS_ATTR_ZONE_STRIDE;
+            esp_zb_custom_cluster_add_custom_attr(cfg_cl, base + SHS_ZONE_FIELD_START_CM,
+                                                  ESP_ZB_ZCL_ATTR_TYPE_U16, ESP_ZB_ZCL_ATTR_ACCESS_READ_WRITE,
+                                                  &shs_zones[z].start_cm);
+            esp_zb_custom_cluster_add_custom_attr(cfg_cl, base + SHS_ZONE_FIELD_END_CM,
+                                                  ESP_ZB_ZCL_ATTR_TYPE_U16, ESP_ZB_ZCL_ATTR_ACCESS_READ_WRITE,
+                                                  &shs_zones[z].end_cm);
+            esp_zb_custom_cluster_add_custom_attr(cfg_cl, base + SHS_ZONE_FIELD_CLEAR_S,
+                                                  ESP_ZB_ZCL_ATTR_TYPE_U16, ESP_ZB_ZCL_ATTR_ACCESS_READ_WRITE,
+                                                  &shs_zones[z].clear_s);
+        }
+
+        for (size_t i = 0; i < sizeof(shs_hold_attrs) / sizeof(shs_hold_attrs[0]); ++i) {
+            esp_zb_custom_cluster_add_custom_attr(cfg_cl, shs_hold_attrs[i].attr,
+                                                  ESP_ZB_ZCL_ATTR_TYPE_U16, ESP_ZB_ZCL_ATTR_ACCESS_READ_WRITE,
+                                                  shs_hold_attrs[i].val);
+        }
+
+        if (shs_radar_driver.fine_res) {
+            esp_zb_custom_cluster_add_custom_attr(cfg_cl, SHS_ATTR_DIST_RESOLUTION,
+                                                  ESP_ZB_ZCL_ATTR_TYPE_U16, ESP_ZB_ZCL_ATTR_ACCESS_READ_WRITE,
+                                                  &shs_dist_res);
+        }
+
+        if (shs_radar_driver.per_gate_thr) {
+            esp_zb_custom_cluster_add_custom_attr(cfg_cl, SHS_ATTR_CALIBRATE,
+                                                  ESP_ZB_ZCL_ATTR_TYPE_U16, ESP_ZB_ZCL_ATTR_ACCESS_READ_WRITE,
+                                                  &shs_calib_s);
+        }
+
+        /* Per-gate thresholds, one attribute per gate of the selected model */
+        if (shs_radar_driver.per_gate_thr) {
+            for (uint16_t g = 0; g <= shs_radar_driver.max_gate; ++g) {
+                esp_zb_custom_cluster_add_custom_attr(cfg_cl, SHS_ATTR_MV_GATE_THR_BASE + g,
+                                                      ESP_ZB_ZCL_ATTR_TYPE_U16, ESP_ZB_ZCL_ATTR_ACCESS_READ_WRITE,
+                                                      &shs_mv_gate_thr[g]);
+                esp_zb_custom_cluster_add_custom_attr(cfg_cl, SHS_ATTR_ST_GATE_THR_BASE + g,
+                                                      ESP_ZB_ZCL_ATTR_TYPE_U16, ESP_ZB_ZCL_ATTR_ACCESS_READ_WRITE,
+                                                      &shs_st_gate_thr[g]);
+            }
+        }
+
+        /* Read-only parser diagnostics */
+        esp_zb_custom_cluster_add_custom_attr(cfg_cl, SHS_ATTR_DIAG_GOOD_FRAMES,
+                                              ESP_ZB_ZCL_ATTR_TYPE_U32, ESP_ZB_ZCL_ATTR_ACCESS_READ_ONLY,
+                                              &shs_radar_stats.good_frames);
+        esp_zb_custom_cluster_add_custom_attr(cfg_cl, SHS_ATTR_DIAG_BAD_FRAMES,
+                                              ESP_ZB_ZCL_ATTR_TYPE_U32, ESP_ZB_ZCL_ATTR_ACCESS_READ_ONLY,
+                                              &shs_radar_stats.bad_frames);
+        esp_zb_custom_cluster_add_custom_attr(cfg_cl, SHS_ATTR_DIAG_RESYNCS,
+                                              ESP_ZB_ZCL_ATTR_TYPE_U32, ESP_ZB_ZCL_ATTR_ACCESS_READ_ONLY,
+                                              &shs_radar_stats.resyncs);
+        esp_zb_custom_cluster_add_custom_attr(cfg_cl, SHS_ATTR_DIAG_DROPPED_BYTES,
+                                              ESP_ZB_ZCL_ATTR_TYPE_U32, ESP_ZB_ZCL_ATTR_ACCESS_READ_ONLY,
+                                              &shs_radar_stats.dropped_bytes);
+        esp_zb_custom_cluster_add_custom_attr(cfg_cl, SHS_ATTR_DIAG_DUP_FRAMES,
+                                              ESP_ZB_ZCL_ATTR_TYPE_U32, ESP_ZB_ZCL_ATTR_ACCESS_READ_ONLY,
+                                              &shs_radar_stats.duplicate_frames);
+        esp_zb_custom_cluster_add_custom_attr(cfg_cl, SHS_ATTR_DIAG_CMD_FAILURES,
+                                              ESP_ZB_ZCL_ATTR_TYPE_U32, ESP_ZB_ZCL_ATTR_ACCESS_READ_ONLY,
+                                              &shs_radar_stats.cmd_failures);
+        esp_zb_custom_cluster_add_custom_attr(cfg_cl, SHS_ATTR_DIAG_CMD_RETRIES,
+                                              ESP_ZB_ZCL_ATTR_TYPE_U32, ESP_ZB_ZCL_ATTR_ACCESS_READ_ONLY,
+                                              &shs_radar_stats.cmd_retries);
+        esp_zb_custom_cluster_add_custom_attr(cfg_cl, SHS_ATTR_DIAG_CMD_RTT_MAX_MS,
+                                              ESP_ZB_ZCL_ATTR_TYPE_U32, ESP_ZB_ZCL_ATTR_ACCESS_READ_ONLY,
+                                              &shs_radar_stats.cmd_rtt_max_ms);
+        esp_zb_custom_cluster_add_custom_attr(cfg_cl, SHS_ATTR_DIAG_LINK_STATE,
+                                              ESP_ZB_ZCL_ATTR_TYPE_U32, ESP_ZB_ZCL_ATTR_ACCESS_READ_ONLY | ESP_ZB_ZCL_ATTR_ACCESS_REPORTING,
+                                              &shs_link_state);
+        esp_zb_custom_cluster_add_custom_attr(cfg_cl, SHS_ATTR_DIAG_LINK_LOSSES,
+                                              ESP_ZB_ZCL_ATTR_TYPE_U32, ESP_ZB_ZCL_ATTR_ACCESS_READ_ONLY,
+                                              &shs_radar_stats.link_losses);
+        esp_zb_custom_cluster_add_custom_attr(cfg_cl, SHS_ATTR_DIAG_LINK_RECOVERIES,
+                                              ESP_ZB_ZCL_ATTR_TYPE_U32, ESP_ZB_ZCL_ATTR_ACCESS_READ_ONLY,
+                                              &shs_radar_stats.link_recoveries);
+        esp_zb_custom_cluster_add_custom_attr(cfg_cl, SHS_ATTR_DIAG_DRIFT_EVENTS,
+                                              ESP_ZB_ZCL_ATTR_TYPE_U32, ESP_ZB_ZCL_ATTR_ACCESS_READ_ONLY,
+                                              &shs_radar_stats.drift_events);
+        esp_zb_custom_cluster_add_custom_attr(cfg_cl, SHS_ATTR_DIAG_INTERF_GATES,
+                                              ESP_ZB_ZCL_ATTR_TYPE_U32, ESP_ZB_ZCL_ATTR_ACCESS_READ_ONLY,
+                                              &shs_interf_gates);
+        esp_zb_custom_cluster_add_custom_attr(cfg_cl, SHS_ATTR_DIAG_INTERF_SUPPRESSED,
+                                              ESP_ZB_ZCL_ATTR_TYPE_U32, ESP_ZB_ZCL_ATTR_ACCESS_READ_ONLY,
+                                              &shs_interf_suppressed);
+
         esp_zb_cluster_list_add_custom_cluster(cl, cfg_cl, ESP_ZB_ZCL_CLUSTER_SERVER_ROLE);
 
         esp_zb_endpoint_config_t ep_cfg = {
@@ -754,7 +1551,14 @@ static void shs_zigbee_task(void *pvParameters)
         esp_zb_custom_cluster_add_custom_attr(occ, SHS_ATTR_OCC_STATIC_TARGET,
                                             ESP_ZB_ZCL_ATTR_TYPE_BOOL, ESP_ZB_ZCL_ATTR_ACCESS_READ_ONLY | ESP_ZB_ZCL_ATTR_ACCESS_REPORTING,
                                             &shs_static_state);
-
+        if (shs_radar_driver.has_distance) {
+            esp_zb_custom_cluster_add_custom_attr(occ, SHS_ATTR_OCC_TARGET_DIR,
+                                                ESP_ZB_ZCL_ATTR_TYPE_U8, ESP_ZB_ZCL_ATTR_ACCESS_READ_ONLY | ESP_ZB_ZCL_ATTR_ACCESS_REPORTING,
+                                                &shs_target_dir);
+        }
+        esp_zb_custom_cluster_add_custom_attr(occ, SHS_ATTR_OCC_CONFIDENCE,
+                                            ESP_ZB_ZCL_ATTR_TYPE_U8, ESP_ZB_ZCL_ATTR_ACCESS_READ_ONLY | ESP_ZB_ZCL_ATTR_ACCESS_REPORTING,
+                                            &shs_confidence);
 
         esp_zb_cluster_list_add_occupancy_sensing_cluster(cl, occ, ESP_ZB_ZCL_CLUSTER_SERVER_ROLE);
 
@@ -767,6 +1571,20 @@ static void shs_zigbee_task(void *pvParameters)
         esp_zb_ep_list_add_ep(dev_ep_list, cl, ep_cfg);
     }
 
+    /* EP3..: one Occupancy Sensor per distance zone (unoccupied while off; none without distances) */
+    for (uint8_t z = 0; z < SHS_ZONE_COUNT && shs_radar_driver.has_distance; ++z) {
+        esp_zb_cluster_list_t *cl = esp_zb_zcl_cluster_list_create();
+        esp_zb_cluster_list_add_occupancy_sensing_cluster(cl, esp_zb_occupancy_sensing_cluster_create(NULL),
+                                                          ESP_ZB_ZCL_CLUSTER_SERVER_ROLE);
+        esp_zb_endpoint_config_t ep_cfg = {
+            .endpoint = SHS_EP_ZONE_BASE + z,
+            .app_profile_id = ESP_ZB_AF_HA_PROFILE_ID,
+            .app_device_id = 0x0107, /* Occupancy Sensor */
+            .app_device_version = 0
+        };
+        esp_zb_ep_list_add_ep(dev_ep_list, cl, ep_cfg);
+    }
+
     /* Register device and start */
     esp_zb_device_register(dev_ep_list);
     esp_zb_core_action_handler_register(shs_zb_action_handler);
@@ -779,8 +1597,8 @@ static void shs_zigbee_task(void *pvParameters)
 /* ---------------- Save worker task ---------------- */
 static void shs_save_worker(void *pv)
 {
-    TickType_t last_mv_sens = 0, last_st_sens = 0, last_mv_gate = 0, last_st_gate = 0;
-    bool pend_mv_sens = false, pend_st_sens = false, pend_mv_gate = false, pend_st_gate = false;
+    TickType_t last_mv_sens = 0, last_st_sens = 0, last_mv_gate = 0, last_st_gate = 0, last_gate_thr = 0, last_zones = 0;
+    bool pend_mv_sens = false, pend_st_sens = false, pend_mv_gate = false, pend_st_gate = false, pend_gate_thr = false, pend_zones = false;
     uint8_t mv_sens_val = shs_moving_sens_0_100, st_sens_val = shs_static_sens_0_100;
     uint8_t mv_gate_val = (uint8_t)shs_moving_max_gate, st_gate_val = (uint8_t)shs_static_max_gate;
 
@@ -793,6 +1611,15 @@ static void shs_save_worker(void *pv)
                         shs_cfg_save_u16(SHS_NVS_KEY_MV_CD, shs_movement_cooldown_sec);
                     } else if ((m.u16 >> 8) == SHS_ATTR_OCC_CLEAR_COOLDOWN) {
                         shs_cfg_save_u16(SHS_NVS_KEY_OCC_CD, shs_occupancy_clear_sec);
+                    } else if ((m.u16 >> 8) == SHS_ATTR_INTERF_SUPPRESS) {
+                        shs_cfg_save_u8(SHS_NVS_KEY_INTERF, (uint8_t)shs_interf_enable);
+                    } else if ((m.u16 >> 8) == SHS_ATTR_PRETRIGGER_CM) {
+                        shs_cfg_save_u16(SHS_NVS_KEY_PRETRIG, shs_pretrigger_cm);
+                    } else if ((m.u16 >> 8) == SHS_ATTR_DIST_RESOLUTION) {
+                        shs_cfg_save_u8(SHS_NVS_KEY_DIST_RES, (uint8_t)shs_dist_res);
+                    } else {
+                        const shs_hold_attr_t *a = shs_hold_attr_find(m.u16 >> 8);
+                        if (a) shs_cfg_save_u16(a->key, *a->val);
                     }
                     break;
                 case SHS_SAVE_DEBOUNCE_SENS_MOVE:
@@ -807,6 +1634,12 @@ static void shs_save_worker(void *pv)
                 case SHS_SAVE_DEBOUNCE_GATE_STATIC:
                     st_gate_val = (uint8_t)m.u16; pend_st_gate = true; last_st_gate = xTaskGetTickCount();
                     break;
+                case SHS_SAVE_DEBOUNCE_GATE_THR:
+                    pend_gate_thr = true; last_gate_thr = xTaskGetTickCount();
+                    break;
+                case SHS_SAVE_DEBOUNCE_ZONES:
+                    pend_zones = true; last_zones = xTaskGetTickCount();
+                    break;
             }
         }
 
@@ -827,6 +1660,15 @@ static void shs_save_worker(void *pv)
             shs_cfg_save_u8(SHS_NVS_KEY_ST_GATE, st_gate_val);
             pend_st_gate = false;
         }
+        if (pend_gate_thr && (now - last_gate_thr) >= pdMS_TO_TICKS(SHS_NVS_DEBOUNCE_MS)) {
+            shs_cfg_save_gate_thr(SHS_NVS_KEY_MV_GTHR, shs_mv_gate_thr);
+            shs_cfg_save_gate_thr(SHS_NVS_KEY_ST_GTHR, shs_st_gate_thr);
+            pend_gate_thr = false;
+        }
+        if (pend_zones && (now - last_zones) >= pdMS_TO_TICKS(SHS_NVS_DEBOUNCE_MS)) {
+            shs_cfg_save_zones();
+            pend_zones = false;
+        }
     }
 }
 
@@ -843,33 +1685,29 @@ void app_main(void)
     /* Light driver: init immediately at boot */
     shs_deferred_driver_init();
 
-    /* UART init */
-    uart_config_t uart_config = {
-        .baud_rate = 57600,
-        .data_bits = UART_DATA_8_BITS,
-        .parity    = UART_PARITY_DISABLE,
-        .stop_bits = UART_STOP_BITS_1,
-        .flow_ctrl = UART_HW_FLOWCTRL_DISABLE,
-        .source_clk= UART_SCLK_DEFAULT,
-    };
-    ESP_ERROR_CHECK(uart_driver_install(SHS_LD2410_UART_NUM, SHS_UART_ACC_BUF_SIZE, 0, 0, NULL, 0));
-    ESP_ERROR_CHECK(uart_param_config(SHS_LD2410_UART_NUM, &uart_config));
-    ESP_ERROR_CHECK(uart_set_pin(SHS_LD2410_UART_NUM, SHS_LD2410_UART_TX_PIN, SHS_LD2410_UART_RX_PIN,
-                                 UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE));
-    ESP_LOGI(SHS_TAG, "LD2410 UART driver initialized");
-
-    /* Load settings & push to LD2410 */
+    /* Settings first: the cached baud seeds the UART */
     shs_cfg_load_from_nvs();
-    shs_ld2410_disable_ble();
-    shs_ld2410_apply_global_sensitivity();
-    shs_ld2410_apply_params_all();
+    if (shs_radar_baud == 0) shs_radar_baud = shs_radar_driver.default_baud;
+
+    /* UART init */
+    ESP_ERROR_CHECK(shs_radar_uart_init(shs_radar_baud));
+    /* Hold timers only wake the radar task, which owns the channels */
+    ESP_ERROR_CHECK(shs_hold_init(&shs_hold_mv, shs_radar_wake));
+    ESP_ERROR_CHECK(shs_hold_init(&shs_hold_st, shs_radar_wake));
+    ESP_ERROR_CHECK(shs_hold_init(&shs_hold_occ, shs_radar_wake));
+    for (size_t z = 0; z < SHS_ZONE_COUNT; ++z) ESP_ERROR_CHECK(shs_hold_init(&shs_hold_zone[z], shs_radar_wake));
+    esp_err_t out_rc = shs_radar_out_pin_init(shs_out_pin_changed);
+    if (out_rc != ESP_OK) ESP_LOGW(SHS_TAG, "OUT pin fast path unavailable (%s)", esp_err_to_name(out_rc));
+
+    /* Baud negotiation, radar bring-up and all later config writes run in the command worker */
+    shs_radar_cmd_q = xQueueCreate(SHS_RADAR_CMD_QUEUE_LEN, sizeof(uint32_t));
+    xTaskCreate(shs_radar_cmd_worker, "shs_radar_cmd",   4096, NULL, 4, NULL);
 
     /* Save worker (debounce + off-thread writes) */
     shs_save_q = xQueueCreate(8, sizeof(shs_save_msg_t));
     xTaskCreate(shs_save_worker, "shs_save_worker", 3072, NULL, 3, NULL);
 
     /* Tasks */
-    xTaskCreate(shs_ld2410_task,      "shs_ld2410_task", 4096, NULL, 6, NULL);
     xTaskCreate(shs_boot_button_task, "shs_boot_button", 2048, NULL, 4, NULL);
     xTaskCreate(shs_zigbee_task,      "shs_zigbee_main", 4096, NULL, 5, NULL);
 }
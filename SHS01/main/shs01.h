@@ -6,6 +6,7 @@
 #ifndef SHS01_H
 #define SHS01_H
 
+#include "sdkconfig.h"
 #include "esp_zigbee_core.h"
 #include "driver/gpio.h"
 #include "driver/uart.h"
@@ -17,6 +18,8 @@
 /* Endpoints */
 #define SHS_EP_LIGHT                    1   /* genOnOff Light + Config */
 #define SHS_EP_OCC                      2   /* Occupancy Sensing cluster (moving, static, overall) */
+#define SHS_EP_ZONE_BASE                3   /* + zone: Occupancy Sensing per distance zone */
+#define SHS_ZONE_COUNT                  4
 
 /* Router device config */
 #define SHS_ZR_CONFIG()                                         \
@@ -33,55 +36,38 @@
 
 /* Manufacturer / Model strings for Basic cluster (length-prefixed ASCII) */
 #define SHS_MANUFACTURER_NAME           "\x0E""SmartHomeScene"
+#if CONFIG_SHS_RADAR_LD2412
+#define SHS_MODEL_IDENTIFIER            "\x05""SHS02"
+#define SHS_BASIC_SW_BUILD_ID           "\x0B""SHS02-1.0.0"
+#elif CONFIG_SHS_RADAR_SEN0557
+#define SHS_MODEL_IDENTIFIER            "\x05""SHS03"      /* presence only: no per-gate or resolution attributes */
+#define SHS_BASIC_SW_BUILD_ID           "\x0B""SHS03-1.0.0"
+#else
 #define SHS_MODEL_IDENTIFIER            "\x05""SHS01"
+#define SHS_BASIC_SW_BUILD_ID           "\x0B""SHS01-1.0.0"     /* adjust as needed */
+#endif
 
 /* Optional Basic metadata (length-prefixed ZCL char strings) */
 #define SHS_BASIC_DATE_CODE             "\x0A""2025-08-29"      /* YYYY-MM-DD (10) */
-#define SHS_BASIC_SW_BUILD_ID           "\x0B""SHS01-1.0.0"     /* adjust as needed */
 
-/* ---------------- LD2410C UART pins ---------------- */
-#define SHS_LD2410_UART_NUM             (UART_NUM_1)
-#define SHS_LD2410_UART_RX_PIN          (GPIO_NUM_4)
-#define SHS_LD2410_UART_TX_PIN          (GPIO_NUM_5)
-
-/* Increase buffers for robustness under bursty frames */
-#define SHS_UART_BUF_SIZE               (512)   /* per read() temp */
-#define SHS_UART_ACC_BUF_SIZE           (1024)  /* accumulator size */
-
-/* ---------------- LD2410C constants ---------------- */
-#define SHS_LD2410_HDR_TX0              0xFD
-#define SHS_LD2410_HDR_TX1              0xFC
-#define SHS_LD2410_HDR_TX2              0xFB
-#define SHS_LD2410_HDR_TX3              0xFA
-#define SHS_LD2410_TAIL_TX0             0x04
-#define SHS_LD2410_TAIL_TX1             0x03
-#define SHS_LD2410_TAIL_TX2             0x02
-#define SHS_LD2410_TAIL_TX3             0x01
-
-#define SHS_LD2410_HDR_RX0              0xF4
-#define SHS_LD2410_HDR_RX1              0xF3
-#define SHS_LD2410_HDR_RX2              0xF2
-#define SHS_LD2410_HDR_RX3              0xF1
-#define SHS_LD2410_TAIL_RX0             0xF8
-#define SHS_LD2410_TAIL_RX1             0xF7
-#define SHS_LD2410_TAIL_RX2             0xF6
-#define SHS_LD2410_TAIL_RX3             0xF5
-
-#define SHS_LD2410_MIN_FRAME_BYTES      9
-
-/* Commands */
-#define SHS_LD2410_CMD_BEGIN_CONFIG     0x00FF
-#define SHS_LD2410_CMD_SET_PARAMS       0x0060
-#define SHS_LD2410_CMD_SET_SENSITIVITY  0x0064
-#define SHS_LD2410_CMD_END_CONFIG       0x00FE
-#define SHS_LD2410_CMD_BLE_ENABLE       0x00A4
-#define SHS_LD2410_CMD_RESTART_MODULE   0x00A3
-
-/* Parameters */
-#define SHS_LD2410_PW_MAX_MOVE_GATE     0x0000
-#define SHS_LD2410_PW_MAX_STATIC_GATE   0x0001
-#define SHS_LD2410_PW_NO_ONE_DURATION   0x0002
-#define SHS_LD2410_GATE_ALL             0xFFFF
+/* ---------------- Radar task ---------------- */
+/* Upper bound on an event wait so timers still advance if the module goes quiet */
+#define SHS_RADAR_IDLE_WAIT_MS          (1000)
+/* No valid frame for this long: frame targets are dropped, occupancy follows the OUT pin */
+#define SHS_RADAR_LINK_STALE_MS         (5000)
+
+/* Link watchdog (command worker): one recovery step per interval while stale */
+#define SHS_RADAR_WD_CHECK_MS           (1000)
+#define SHS_RADAR_WD_STEP_MS            (5000)
+#define SHS_RADAR_WD_RETRY_MS           (60000) /* restart + re-apply again once the link is down */
+
+/* Config drift check (command worker): read the module back, re-apply on mismatch */
+#define SHS_RADAR_DRIFT_CHECK_MS        (900000)
+#define SHS_RADAR_DRIFT_QUIET_MS        (60000) /* only after this long without presence */
+
+/* Radar command worker: pending apply requests from the Zigbee handler */
+#define SHS_RADAR_CMD_QUEUE_LEN         8
+#define SHS_RADAR_CMD_COALESCE_MS       300     /* gather a slider burst into one session */
 
 /* ---------------- Custom Config Cluster ---------------- */
 #define SHS_CL_CFG_ID                   0xFDCD
@@ -92,10 +78,51 @@
 #define SHS_ATTR_STATIC_SENS_0_10       0x0004
 #define SHS_ATTR_MOVING_MAX_GATE        0x0005
 #define SHS_ATTR_STATIC_MAX_GATE        0x0006
+#define SHS_ATTR_DIST_RESOLUTION        0x0007  /* 0 = 0.75 m gates, 1 = 0.2 m; only on fine_res drivers */
+#define SHS_ATTR_CALIBRATE              0x0008  /* write window s to start, 0 to cancel; per-gate drivers */
+
+/* Hold delays per published channel; moving clear delay is SHS_ATTR_MOVEMENT_COOLDOWN */
+#define SHS_ATTR_MOVING_ASSERT_MS       0x0009
+#define SHS_ATTR_STATIC_ASSERT_MS       0x000A
+#define SHS_ATTR_STATIC_CLEAR_S         0x000B
+#define SHS_ATTR_OCC_ASSERT_MS          0x000C
+#define SHS_ATTR_OCC_CLEAR_S            0x000D
+#define SHS_ATTR_PRETRIGGER_CM          0x000E  /* assert occupancy early when an approaching target will
+                                                 * be this close within SHS_TRACK_LEAD_MS; 0 = off */
+#define SHS_ATTR_INTERF_SUPPRESS        0x000F  /* 1 = learn and mask steady interferers (shs_interf.h); default 0 */
+
+/* Distance zones (U16): 0x0050 + 4 * zone + field; a zone with end_cm == 0 is off */
+#define SHS_ATTR_ZONE_BASE              0x0050
+#define SHS_ATTR_ZONE_STRIDE            4
+#define SHS_ZONE_FIELD_START_CM         0
+#define SHS_ZONE_FIELD_END_CM           1
+#define SHS_ZONE_FIELD_CLEAR_S          2
+
+/* Per-gate thresholds (U16 0..100, 0 = global sensitivity); only on per-gate drivers */
+#define SHS_ATTR_MV_GATE_THR_BASE       0x0010  /* + gate */
+#define SHS_ATTR_ST_GATE_THR_BASE       0x0030  /* + gate */
+
+/* Read-only diagnostics (U32) */
+#define SHS_ATTR_DIAG_GOOD_FRAMES       0x0100
+#define SHS_ATTR_DIAG_BAD_FRAMES        0x0101
+#define SHS_ATTR_DIAG_RESYNCS           0x0102
+#define SHS_ATTR_DIAG_DROPPED_BYTES     0x0103
+#define SHS_ATTR_DIAG_DUP_FRAMES        0x0104
+#define SHS_ATTR_DIAG_CMD_FAILURES      0x0105
+#define SHS_ATTR_DIAG_CMD_RETRIES       0x0106
+#define SHS_ATTR_DIAG_CMD_RTT_MAX_MS    0x0107
+#define SHS_ATTR_DIAG_LINK_STATE        0x0108  /* shs_link_state_t */
+#define SHS_ATTR_DIAG_LINK_LOSSES       0x0109
+#define SHS_ATTR_DIAG_LINK_RECOVERIES   0x010A
+#define SHS_ATTR_DIAG_DRIFT_EVENTS      0x010B
+#define SHS_ATTR_DIAG_INTERF_GATES      0x010C  /* bitmask of masked gates */
+#define SHS_ATTR_DIAG_INTERF_SUPPRESSED 0x010D  /* frames whose moving target was dropped */
 
 /* ---------------- Occupancy custom attributes ---------------- */
 #define SHS_ATTR_OCC_MOVING_TARGET      0xF001
 #define SHS_ATTR_OCC_STATIC_TARGET      0xF002
+#define SHS_ATTR_OCC_TARGET_DIR         0xF003  /* U8 shs_track_dir_t, reportable */
+#define SHS_ATTR_OCC_CONFIDENCE         0xF004  /* U8 0..100, reportable; >= 50 while a target is reported */
 
 /* ---------------- Occupancy Sensing cluster optional attr IDs ---------------- */
 #define SHS_ZCL_ATTR_OCC_PIR_OU_DELAY   0x0010
@@ -104,8 +131,33 @@
 #define SHS_BOOT_BUTTON_GPIO            GPIO_NUM_9
 #define SHS_FACTORY_RESET_LONGPRESS_MS  6000
 
+/* ---------------- Empty-room calibration ---------------- */
+#define SHS_CALIB_DEFAULT_S             60      /* window for the button gesture */
+#define SHS_CALIB_MIN_S                 10
+#define SHS_CALIB_MAX_S                 600
+#define SHS_CALIB_SETTLE_MS             15000   /* time to leave the room before sampling */
+#define SHS_CALIB_MIN_SAMPLES           20      /* per gate, else the gate is left alone */
+#define SHS_CALIB_SIGMAS                3       /* threshold >= mean + SIGMAS * sd */
+#define SHS_CALIB_MARGIN                5       /* added on top of the noise estimate */
+#define SHS_CALIB_GESTURE_PRESSES       3       /* short BOOT presses ... */
+#define SHS_CALIB_GESTURE_WINDOW_MS     2000    /* ... within this window */
+#define SHS_CALIB_GESTURE_PRESS_MAX_MS  500     /* longer presses are not counted */
+
+/* ---------------- Target tracker ---------------- */
+#define SHS_TRACK_LEAD_MS               500     /* pre-trigger look-ahead */
+#define SHS_TRACK_REFEED_MS             500     /* repeated frames: re-run the tracker this often (< SHS_TRACK_LOST_MS) */
+
+/* ---------------- Presence confidence ---------------- */
+#define SHS_CONF_SMOOTH_SHIFT           3       /* EMA weight 1/8 per frame (~1 s at 10 Hz) */
+#define SHS_CONF_REPORT_CHANGE          5       /* attribute moves in steps of at least this */
+#define SHS_CONF_MAX_STEPS              32      /* per radar loop pass; settled well before */
+
 /* ---------------- Debounce ---------------- */
 #define SHS_NVS_DEBOUNCE_MS             500
-#define SHS_COOLDOWN_MAX_SEC            300
+#define SHS_COOLDOWN_MAX_SEC            300     /* also caps the other clear delays */
+#define SHS_HOLD_ASSERT_MAX_MS          10000
+
+/* ---------------- Diagnostics ---------------- */
+#define SHS_DIAG_PUBLISH_MS             60000
 
 #endif /* SHS01_H */
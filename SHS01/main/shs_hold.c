@@ -0,0 +1,90 @@
+/*
+ * SPDX-FileCopyrightText: 2021-2025
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "esp_log.h"
+#include "esp_timer.h"
+
+#include "shs_hold.h"
+
+static const char *SHS_TAG = "SHS_HOLD";
+
+static void shs_hold_timer_cb(void *arg)
+{
+    void (*wake)(void) = (void (*)(void))arg;
+    wake();
+}
+
+esp_err_t shs_hold_init(shs_hold_t *h, void (*wake)(void))
+{
+    const esp_timer_create_args_t args = {
+        .callback = shs_hold_timer_cb,
+        .arg = (void *)wake,
+        .dispatch_method = ESP_TIMER_TASK,
+        .name = h->name,
+    };
+    h->pending = false;
+    return esp_timer_create(&args, &h->timer);
+}
+
+static void shs_hold_publish(shs_hold_t *h, bool state)
+{
+    h->out = state;
+    if (h->on_change) h->on_change(h, state);
+}
+
+static void shs_hold_cancel(shs_hold_t *h)
+{
+    if (!h->pending) return;
+    h->pending = false;
+    if (h->timer) (void)esp_timer_stop(h->timer); /* not running is fine */
+}
+
+void shs_hold_input(shs_hold_t *h, bool in)
+{
+    h->in = in;
+    if (in == h->out) {
+        shs_hold_cancel(h);
+        return;
+    }
+    if (h->pending) return; /* already counting down towards in */
+
+    uint64_t delay_us = in ? (uint64_t)*h->assert_ms * 1000ULL : (uint64_t)*h->clear_s * 1000000ULL;
+    if (delay_us == 0 || !h->timer) {
+        shs_hold_publish(h, in);
+        return;
+    }
+    h->pending = true;
+    h->deadline_us = esp_timer_get_time() + (int64_t)delay_us;
+    if (esp_timer_start_once(h->timer, delay_us) != ESP_OK) {
+        ESP_LOGW(SHS_TAG, "%s: timer start failed, publishing now", h->name);
+        h->pending = false;
+        shs_hold_publish(h, in);
+    }
+}
+
+void shs_hold_tick(shs_hold_t *h)
+{
+    if (!h->pending || esp_timer_get_time() < h->deadline_us) return;
+    h->pending = false;
+    if (h->in != h->out) shs_hold_publish(h, h->in);
+}
+
+void shs_hold_trigger(shs_hold_t *h)
+{
+    if (h->out) return;
+    shs_hold_cancel(h);
+    shs_hold_publish(h, true);
+    if (!h->in) shs_hold_input(h, false);
+}
+
+void shs_hold_force(shs_hold_t *h, bool state)
+{
+    shs_hold_cancel(h);
+    h->in = state;
+    if (state != h->out) shs_hold_publish(h, state);
+}
@@ -0,0 +1,49 @@
+/*
+ * SPDX-FileCopyrightText: 2021-2025
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+#ifndef SHS_HOLD_H
+#define SHS_HOLD_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+#include "esp_timer.h"
+
+/* ---------------- Hold / hysteresis channel ----------------
+ * A raw input is published only after it has stayed at the new level for
+ * the channel's assert delay (rising) or clear delay (falling). Deadlines
+ * run on a one-shot esp_timer whose callback only wakes the owner task;
+ * the owner calls shs_hold_tick() there, so all state stays on one task.
+ * Delays are read when a transition is armed, so the backing attributes
+ * can be written from the Zigbee task at any time. */
+typedef struct shs_hold shs_hold_t;
+typedef void (*shs_hold_cb_t)(shs_hold_t *h, bool state);
+
+struct shs_hold {
+    const char        *name;
+    const uint16_t    *assert_ms;   /* rising delay, ms */
+    const uint16_t    *clear_s;     /* falling delay, s */
+    shs_hold_cb_t      on_change;
+
+    bool               in;          /* last raw input */
+    bool               out;         /* published state */
+    bool               pending;     /* out will follow in at deadline_us */
+    int64_t            deadline_us;
+    esp_timer_handle_t timer;
+};
+
+/* Create the channel timer; wake runs on the esp_timer task when a deadline passes */
+esp_err_t shs_hold_init(shs_hold_t *h, void (*wake)(void));
+/* New raw level: publish now (zero delay), arm, or cancel a pending transition */
+void shs_hold_input(shs_hold_t *h, bool in);
+/* Publish a transition whose deadline has passed */
+void shs_hold_tick(shs_hold_t *h);
+/* Publish true now, skipping the assert delay; the clear delay runs if in is false */
+void shs_hold_trigger(shs_hold_t *h);
+/* Set in and out at once (e.g. link lost), dropping any pending transition */
+void shs_hold_force(shs_hold_t *h, bool state);
+
+#endif /* SHS_HOLD_H */
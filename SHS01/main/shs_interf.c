@@ -0,0 +1,82 @@
+/*
+ * SPDX-FileCopyrightText: 2021-2025
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "esp_log.h"
+
+#include "shs_interf.h"
+
+static const char *SHS_TAG = "SHS_INTERF";
+
+_Static_assert((SHS_INTERF_RING & (SHS_INTERF_RING - 1)) == 0, "SHS_INTERF_RING must be a power of two");
+
+void shs_interf_reset(shs_interf_t *s)
+{
+    memset(s, 0, sizeof(*s));
+}
+
+bool shs_interf_update(shs_interf_t *s, const uint8_t *energy, const uint8_t *thr,
+                       uint8_t n_gates, uint8_t max_gate)
+{
+    if (n_gates > SHS_RADAR_MAX_GATES) n_gates = SHS_RADAR_MAX_GATES;
+    const uint8_t slot = s->head;
+    const bool full = (s->fill == SHS_INTERF_RING);
+    bool motion = false;
+
+    for (uint8_t g = 0; g < n_gates; ++g) {
+        const uint8_t e = energy[g];
+        const uint32_t bit = 1UL << g;
+
+        /* slide the window: the oldest sample leaves once the ring is full */
+        uint8_t old = full ? s->ring[g][slot] : 0;
+        s->ring[g][slot] = e;
+        s->sum[g] = (uint16_t)(s->sum[g] + e - old);
+        s->sumsq[g] += (uint32_t)e * e - (uint32_t)old * old;
+
+        const bool active = e >= thr[g];
+        if (s->masked & bit) {
+            if (!active) {
+                if (++s->quiet[g] >= SHS_INTERF_RELEASE_FRAMES) {
+                    s->masked &= ~bit;
+                    s->persist[g] = 0;
+                    ESP_LOGI(SHS_TAG, "Gate %u: interferer gone, unmasked", (unsigned)g);
+                }
+            } else {
+                s->quiet[g] = 0;
+            }
+            if (e > s->ceiling[g] && g <= max_gate) motion = true;
+            continue;
+        }
+
+        if (active && g <= max_gate) motion = true;
+        if (!full) continue;
+
+        /* steady: mean above threshold and sd within CV_MAX_PCT of it */
+        uint32_t mean = s->sum[g] / SHS_INTERF_RING;
+        uint32_t msq = s->sumsq[g] / SHS_INTERF_RING;
+        uint32_t var = msq > mean * mean ? msq - mean * mean : 0;
+        bool steady = active && mean >= thr[g] &&
+                      var * 100U * 100U <= (uint32_t)SHS_INTERF_CV_MAX_PCT * SHS_INTERF_CV_MAX_PCT * mean * mean;
+        if (!steady) {
+            s->persist[g] = s->persist[g] > SHS_INTERF_DECAY ? s->persist[g] - SHS_INTERF_DECAY : 0;
+            continue;
+        }
+        if (++s->persist[g] < SHS_INTERF_LEARN_FRAMES) continue;
+
+        uint32_t ceil = mean + SHS_INTERF_SIGMAS * shs_isqrt(var) + SHS_INTERF_MARGIN;
+        s->ceiling[g] = (uint8_t)(ceil > 100 ? 100 : ceil);
+        s->quiet[g] = 0;
+        s->masked |= bit;
+        ESP_LOGW(SHS_TAG, "Gate %u: steady moving energy (mean %u, sd %u), masked below %u",
+                 (unsigned)g, (unsigned)mean, (unsigned)shs_isqrt(var), (unsigned)s->ceiling[g]);
+    }
+
+    s->head = (uint8_t)((slot + 1) & (SHS_INTERF_RING - 1));
+    if (!full) s->fill++;
+    return motion;
+}
@@ -0,0 +1,51 @@
+/*
+ * SPDX-FileCopyrightText: 2021-2025
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+#ifndef SHS_INTERF_H
+#define SHS_INTERF_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "shs_radar.h"
+
+/* ---------------- Interference suppression ----------------
+ * Fans, curtains and vents keep one gate's moving energy above threshold
+ * with a steady, bounded spread. Per gate, the last SHS_INTERF_RING
+ * moving energies are kept with a sliding sum and sum of squares (integer
+ * mean / variance). A gate that stays active and steady for
+ * SHS_INTERF_LEARN_FRAMES is masked: its energy only counts as motion
+ * above a ceiling learned from that spread. A masked gate that stays
+ * below threshold for SHS_INTERF_RELEASE_FRAMES is forgotten. Needs
+ * per-gate energies (engineering frames). Off by default: a person who
+ * sits still but fidgets in one gate could be learned as an interferer. */
+#define SHS_INTERF_RING                 16      /* energies per gate (power of two) */
+#define SHS_INTERF_LEARN_FRAMES         1200    /* ~2 min of steady activity at 10 Hz */
+#define SHS_INTERF_RELEASE_FRAMES       300     /* ~30 s quiet unmasks */
+#define SHS_INTERF_DECAY                4       /* learn credit lost per unsteady frame */
+#define SHS_INTERF_CV_MAX_PCT           35      /* steady: sd <= 35% of mean */
+#define SHS_INTERF_SIGMAS               3       /* ceiling = mean + SIGMAS * sd + MARGIN */
+#define SHS_INTERF_MARGIN               10
+
+typedef struct {
+    uint8_t  ring[SHS_RADAR_MAX_GATES][SHS_INTERF_RING];   /* one contiguous row per gate */
+    uint16_t sum[SHS_RADAR_MAX_GATES];
+    uint32_t sumsq[SHS_RADAR_MAX_GATES];
+    uint16_t persist[SHS_RADAR_MAX_GATES];  /* learn credit (frames) */
+    uint16_t quiet[SHS_RADAR_MAX_GATES];    /* masked: frames below threshold */
+    uint8_t  ceiling[SHS_RADAR_MAX_GATES];  /* masked: energy above this is motion */
+    uint8_t  head;                          /* next ring slot (shared by all gates) */
+    uint8_t  fill;                          /* valid ring entries, up to SHS_INTERF_RING */
+    uint32_t masked;                        /* gate bitmask */
+} shs_interf_t;
+
+void shs_interf_reset(shs_interf_t *s);
+/* Feed one frame's moving energies against the effective gate thresholds.
+ * Returns true if a gate up to max_gate shows motion not explained by a
+ * masked interferer. */
+bool shs_interf_update(shs_interf_t *s, const uint8_t *energy, const uint8_t *thr,
+                       uint8_t n_gates, uint8_t max_gate);
+
+#endif /* SHS_INTERF_H */
@@ -0,0 +1,449 @@
+/*
+ * SPDX-FileCopyrightText: 2021-2025
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+#include <stdbool.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "esp_log.h"
+#include "esp_attr.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "driver/uart.h"
+
+#include "shs_radar.h"
+
+static const char *SHS_TAG = "SHS_RADAR";
+
+_Static_assert((SHS_UART_ACC_BUF_SIZE & SHS_RX_RING_MASK) == 0, "SHS_UART_ACC_BUF_SIZE must be a power of two");
+
+/* ---------------- RX ring ---------------- */
+uint8_t shs_rx_ring[SHS_UART_ACC_BUF_SIZE];
+size_t  shs_rx_rd  = 0;
+size_t  shs_rx_wr  = 0;
+static size_t shs_rx_hwm = 0;  /* highest fill level seen (bytes) */
+
+/* Parser counters; mirrored to EP1 diagnostic attributes */
+shs_radar_stats_t shs_radar_stats;
+
+static QueueHandle_t shs_uart_evt_q;
+
+/* OUT pin edges share the UART event queue so the radar task handles them in order */
+#define SHS_RADAR_EVT_OUT_PIN           ((uart_event_type_t)(UART_EVENT_MAX + 1))
+#define SHS_RADAR_EVT_WAKE              ((uart_event_type_t)(UART_EVENT_MAX + 2))
+static shs_radar_out_cb_t shs_out_cb;
+
+/* Command transactions: one in flight, ACK handed over by the parser */
+static SemaphoreHandle_t shs_cmd_mtx;
+static QueueHandle_t     shs_ack_q;
+static volatile bool     shs_cmd_pending = false;
+static volatile uint16_t shs_cmd_wait    = 0;
+
+/* Baud negotiation runs before the radar task: command waits pump RX themselves */
+static bool              shs_rx_inline = false;
+
+static shs_radar_cmd_stat_t shs_cmd_stat[SHS_RADAR_CMD_STAT_SLOTS];
+static size_t               shs_cmd_stat_n = 0;
+static uint32_t             shs_cmd_total = 0;      /* transactions finished, ok or not */
+
+/* Last processed payload; identical frames skip processing */
+static uint8_t  shs_last_payload[SHS_RADAR_MAX_PAYLOAD_LEN];
+static uint16_t shs_last_payload_len = 0;   /* 0 = none / invalidated */
+
+void shs_radar_fp_invalidate(void)
+{
+    shs_last_payload_len = 0;
+}
+
+bool shs_radar_payload_repeat(size_t off, uint16_t len)
+{
+    if (len > SHS_RADAR_MAX_PAYLOAD_LEN) {
+        shs_last_payload_len = 0;
+        return false;
+    }
+
+    bool same = (len == shs_last_payload_len);
+    for (uint16_t k = 0; k < len; ++k) {
+        uint8_t b = shs_rx_at(off + k);
+        if (shs_last_payload[k] != b) {
+            same = false;
+            shs_last_payload[k] = b;
+        }
+    }
+    shs_last_payload_len = len;
+    return same;
+}
+
+/* Move everything the UART driver has buffered into the ring; returns bytes read */
+static size_t shs_rx_drain_uart(void)
+{
+    size_t total = 0;
+    for (;;) {
+        size_t avail = 0;
+        if (uart_get_buffered_data_len(SHS_RADAR_UART_NUM, &avail) != ESP_OK || avail == 0) break;
+
+        size_t free_space = SHS_UART_ACC_BUF_SIZE - shs_rx_used();
+        if (free_space == 0) break;
+
+        size_t wr_off = shs_rx_wr & SHS_RX_RING_MASK;
+        size_t contig = SHS_UART_ACC_BUF_SIZE - wr_off;
+        if (contig > free_space) contig = free_space;
+        if (contig > avail) contig = avail;
+
+        int len = uart_read_bytes(SHS_RADAR_UART_NUM, &shs_rx_ring[wr_off], contig, 0);
+        if (len <= 0) break;
+        shs_rx_wr += (size_t)len;
+        total += (size_t)len;
+    }
+
+    if (shs_rx_used() > shs_rx_hwm) {
+        shs_rx_hwm = shs_rx_used();
+        ESP_LOGI(SHS_TAG, "RX ring high-water mark: %u/%u bytes",
+                 (unsigned)shs_rx_hwm, (unsigned)SHS_UART_ACC_BUF_SIZE);
+    }
+    return total;
+}
+
+static void shs_rx_reset(void)
+{
+    uart_flush_input(SHS_RADAR_UART_NUM);
+    shs_rx_rd = shs_rx_wr;
+    shs_radar_fp_invalidate();
+}
+
+void shs_radar_write(const uint8_t *buf, size_t len)
+{
+    uart_write_bytes(SHS_RADAR_UART_NUM, (const char *)buf, len);
+}
+
+esp_err_t shs_radar_uart_init(uint32_t baud)
+{
+    if (!shs_cmd_mtx) shs_cmd_mtx = xSemaphoreCreateMutex();
+    if (!shs_ack_q)   shs_ack_q   = xQueueCreate(1, sizeof(shs_radar_ack_t));
+    if (!shs_cmd_mtx || !shs_ack_q) return ESP_ERR_NO_MEM;
+
+    uart_config_t uart_config = {
+        .baud_rate = (int)baud,
+        .data_bits = UART_DATA_8_BITS,
+        .parity    = UART_PARITY_DISABLE,
+        .stop_bits = UART_STOP_BITS_1,
+        .flow_ctrl = UART_HW_FLOWCTRL_DISABLE,
+        .source_clk= UART_SCLK_DEFAULT,
+    };
+    esp_err_t err = uart_driver_install(SHS_RADAR_UART_NUM, SHS_UART_ACC_BUF_SIZE, SHS_UART_TX_BUF_SIZE,
+                                        SHS_UART_EVT_QUEUE_LEN, &shs_uart_evt_q, 0);
+    if (err != ESP_OK) return err;
+    if ((err = uart_param_config(SHS_RADAR_UART_NUM, &uart_config)) != ESP_OK) return err;
+    if ((err = uart_set_pin(SHS_RADAR_UART_NUM, SHS_RADAR_UART_TX_PIN, SHS_RADAR_UART_RX_PIN,
+                            UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE)) != ESP_OK) return err;
+
+    /* Wake the parser on the frame end instead of polling */
+    if ((err = uart_enable_pattern_det_baud_intr(SHS_RADAR_UART_NUM, (char)shs_radar_driver.frame_end_chr, 1,
+                                                 SHS_UART_PATTERN_CHR_TOUT,
+                                                 SHS_UART_PATTERN_POST_IDLE,
+                                                 SHS_UART_PATTERN_PRE_IDLE)) != ESP_OK) return err;
+    if ((err = uart_pattern_queue_reset(SHS_RADAR_UART_NUM, SHS_UART_PATTERN_QUEUE_LEN)) != ESP_OK) return err;
+
+    ESP_LOGI(SHS_TAG, "%s UART driver initialized", shs_radar_driver.name);
+    return ESP_OK;
+}
+
+/* Drop queued UART events only; an OUT edge or wake among them is re-posted
+ * once (the OUT level is re-read, so edges coalesce) */
+static void shs_radar_flush_uart_events(void)
+{
+    uart_event_t ev;
+    bool out_edge = false, wake = false;
+    while (xQueueReceive(shs_uart_evt_q, &ev, 0)) {
+        if (ev.type == SHS_RADAR_EVT_OUT_PIN) out_edge = true;
+        else if (ev.type == SHS_RADAR_EVT_WAKE) wake = true;
+    }
+    if (out_edge) {
+        ev.type = SHS_RADAR_EVT_OUT_PIN;
+        (void)xQueueSend(shs_uart_evt_q, &ev, 0);
+    }
+    if (wake) {
+        ev.type = SHS_RADAR_EVT_WAKE;
+        (void)xQueueSend(shs_uart_evt_q, &ev, 0);
+    }
+}
+
+void shs_radar_poll(TickType_t wait, shs_radar_report_cb_t on_report)
+{
+    uart_event_t ev;
+    if (!xQueueReceive(shs_uart_evt_q, &ev, wait)) return;
+
+    if (ev.type == SHS_RADAR_EVT_OUT_PIN) {
+        if (shs_out_cb) shs_out_cb();
+        return;
+    }
+    if (ev.type == SHS_RADAR_EVT_WAKE) return;
+
+    switch (ev.type) {
+        case UART_PATTERN_DET:
+            /* a frame end has arrived: pull it in and parse once */
+            if (shs_rx_drain_uart() > 0) shs_radar_driver.feed(on_report);
+            while (uart_pattern_pop_pos(SHS_RADAR_UART_NUM) != -1) { }
+            break;
+        case UART_FIFO_OVF:
+        case UART_BUFFER_FULL:
+            ESP_LOGW(SHS_TAG, "UART RX overflow (%d), flushing", (int)ev.type);
+            shs_radar_flush_uart_events();
+            uart_pattern_queue_reset(SHS_RADAR_UART_NUM, SHS_UART_PATTERN_QUEUE_LEN);
+            shs_radar_stats.dropped_bytes += shs_rx_used();
+            shs_rx_reset();
+            break;
+        case UART_DATA:
+            /* ACKs do not end in the frame-end byte: parse on RX idle while one is awaited */
+            if (shs_cmd_pending && shs_rx_drain_uart() > 0) shs_radar_driver.feed(on_report);
+            break;
+        default:
+            /* bytes stay buffered until the next frame end */
+            break;
+    }
+}
+
+void shs_radar_wake(void)
+{
+    if (!shs_uart_evt_q) return;
+    uart_event_t ev = { .type = SHS_RADAR_EVT_WAKE };
+    (void)xQueueSend(shs_uart_evt_q, &ev, 0); /* a full queue wakes the task anyway */
+}
+
+/* ---------------- OUT pin ---------------- */
+#if SHS_RADAR_OUT_GPIO >= 0
+static void IRAM_ATTR shs_radar_out_isr(void *arg)
+{
+    uart_event_t ev = { .type = SHS_RADAR_EVT_OUT_PIN };
+    BaseType_t woken = pdFALSE;
+    xQueueSendFromISR(shs_uart_evt_q, &ev, &woken); /* a full queue is fine: the level is re-read */
+    portYIELD_FROM_ISR(woken);
+}
+
+esp_err_t shs_radar_out_pin_init(shs_radar_out_cb_t on_change)
+{
+    if (!shs_uart_evt_q) return ESP_ERR_INVALID_STATE;
+
+    gpio_config_t io = {
+        .pin_bit_mask = 1ULL << SHS_RADAR_OUT_GPIO,
+        .mode = GPIO_MODE_INPUT,
+        .pull_up_en = GPIO_PULLUP_DISABLE,
+        .pull_down_en = GPIO_PULLDOWN_ENABLE,   /* unpowered module reads as empty */
+        .intr_type = GPIO_INTR_ANYEDGE
+    };
+    esp_err_t err = gpio_config(&io);
+    if (err != ESP_OK) return err;
+
+    err = gpio_install_isr_service(0);
+    if (err != ESP_OK && err != ESP_ERR_INVALID_STATE) return err; /* already installed is fine */
+
+    shs_out_cb = on_change;
+    if ((err = gpio_isr_handler_add(SHS_RADAR_OUT_GPIO, shs_radar_out_isr, NULL)) != ESP_OK) return err;
+
+    ESP_LOGI(SHS_TAG, "OUT pin on GPIO%d (level %d)", SHS_RADAR_OUT_GPIO, gpio_get_level(SHS_RADAR_OUT_GPIO));
+    return ESP_OK;
+}
+
+bool shs_radar_out_level(void)
+{
+    return gpio_get_level(SHS_RADAR_OUT_GPIO) != 0;
+}
+#else
+esp_err_t shs_radar_out_pin_init(shs_radar_out_cb_t on_change)
+{
+    (void)on_change;
+    return ESP_OK;
+}
+
+bool shs_radar_out_level(void)
+{
+    return false;
+}
+#endif
+
+/* ---------------- Command transactions ---------------- */
+static void shs_radar_probe_sink(const shs_radar_report_t *rpt)
+{
+    (void)rpt;
+}
+
+/* Wait for the ACK the parser posts; without a radar task, parse here */
+static bool shs_radar_ack_wait(shs_radar_ack_t *rx, TickType_t wait)
+{
+    if (!shs_rx_inline) return xQueueReceive(shs_ack_q, rx, wait);
+
+    TickType_t t0 = xTaskGetTickCount();
+    for (;;) {
+        if (shs_rx_drain_uart() > 0) shs_radar_driver.feed(shs_radar_probe_sink);
+        if (xQueueReceive(shs_ack_q, rx, 0)) return true;
+        if ((xTaskGetTickCount() - t0) >= wait) return false;
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+}
+
+static void shs_radar_cmd_record(uint16_t cmd, bool ok, uint32_t rtt_ms)
+{
+    shs_radar_cmd_stat_t *st = NULL;
+    for (size_t i = 0; i < shs_cmd_stat_n; ++i) {
+        if (shs_cmd_stat[i].cmd == cmd) { st = &shs_cmd_stat[i]; break; }
+    }
+    if (!st && shs_cmd_stat_n < SHS_RADAR_CMD_STAT_SLOTS) {
+        st = &shs_cmd_stat[shs_cmd_stat_n++];
+        st->cmd = cmd;
+    }
+    shs_cmd_total++;
+
+    if (!ok) {
+        shs_radar_stats.cmd_failures++;
+        if (st) st->failed++;
+        return;
+    }
+    if (rtt_ms > 0xFFFF) rtt_ms = 0xFFFF;
+    if (rtt_ms > shs_radar_stats.cmd_rtt_max_ms) shs_radar_stats.cmd_rtt_max_ms = rtt_ms;
+    if (st) {
+        st->ok++;
+        st->last_ms = (uint16_t)rtt_ms;
+        if (st->max_ms < rtt_ms) st->max_ms = (uint16_t)rtt_ms;
+    }
+}
+
+void shs_radar_ack_post(const shs_radar_ack_t *ack)
+{
+    if (shs_cmd_pending && ack->cmd == shs_cmd_wait) {
+        xQueueOverwrite(shs_ack_q, ack);
+    } else {
+        ESP_LOGD(SHS_TAG, "Unsolicited ACK for cmd 0x%04x", ack->cmd);
+    }
+}
+
+esp_err_t shs_radar_cmd_xfer(uint16_t cmd, const uint8_t *frame, size_t len, shs_radar_ack_t *ack)
+{
+    if (!shs_cmd_mtx) return ESP_ERR_INVALID_STATE;
+
+    shs_radar_ack_t rx;
+    esp_err_t err = ESP_ERR_TIMEOUT;
+    uint32_t t0 = 0;
+
+    xSemaphoreTake(shs_cmd_mtx, portMAX_DELAY);
+    xQueueReset(shs_ack_q);
+    shs_cmd_wait = cmd;
+    shs_cmd_pending = true;
+
+    for (int attempt = 0; attempt < SHS_RADAR_CMD_ATTEMPTS; ++attempt) {
+        if (attempt > 0) shs_radar_stats.cmd_retries++;
+        t0 = esp_log_timestamp();
+        shs_radar_write(frame, len);
+        if (shs_radar_ack_wait(&rx, pdMS_TO_TICKS(SHS_RADAR_CMD_TIMEOUT_MS))) {
+            err = (rx.status == 0) ? ESP_OK : ESP_FAIL;
+            break;
+        }
+    }
+
+    shs_cmd_pending = false;
+    uint32_t rtt = esp_log_timestamp() - t0;
+    shs_radar_cmd_record(cmd, err == ESP_OK, rtt);
+    xSemaphoreGive(shs_cmd_mtx);
+
+    if (err == ESP_OK) {
+        ESP_LOGD(SHS_TAG, "cmd 0x%04x ACK in %ums", cmd, (unsigned)rtt);
+    } else if (err == ESP_FAIL) {
+        ESP_LOGW(SHS_TAG, "cmd 0x%04x rejected (status %u)", cmd, (unsigned)rx.status);
+    } else {
+        ESP_LOGW(SHS_TAG, "cmd 0x%04x: no ACK after %d attempts", cmd, SHS_RADAR_CMD_ATTEMPTS);
+    }
+    if (ack && err != ESP_ERR_TIMEOUT) *ack = rx;
+    return err;
+}
+
+const shs_radar_cmd_stat_t *shs_radar_cmd_stats(size_t *n)
+{
+    *n = shs_cmd_stat_n;
+    return shs_cmd_stat;
+}
+
+uint32_t shs_radar_cmd_count(void)
+{
+    return shs_cmd_total;
+}
+
+/* ---------------- Baud negotiation (boot, before the RX task runs) ---------------- */
+static bool shs_radar_probe_baud(uint32_t baud)
+{
+    uart_set_baudrate(SHS_RADAR_UART_NUM, baud);
+    shs_rx_reset();
+
+    uint32_t good0 = shs_radar_stats.good_frames;
+    TickType_t t0 = xTaskGetTickCount();
+    while ((xTaskGetTickCount() - t0) < pdMS_TO_TICKS(shs_radar_driver.probe_ms)) {
+        vTaskDelay(pdMS_TO_TICKS(20));
+        if (shs_rx_drain_uart() > 0) shs_radar_driver.feed(shs_radar_probe_sink);
+        if (shs_radar_stats.good_frames - good0 >= shs_radar_driver.probe_frames) return true;
+    }
+    return false;
+}
+
+uint32_t shs_radar_baud_negotiate(uint32_t stored, bool *upgrade)
+{
+    const shs_radar_driver_t *drv = &shs_radar_driver;
+    uint32_t locked = 0;
+
+    shs_rx_inline = true;
+    vTaskDelay(pdMS_TO_TICKS(SHS_RADAR_RESTART_MS)); /* wait for module to be ready */
+
+    if (shs_radar_probe_baud(stored)) {
+        locked = stored;
+    } else {
+        for (size_t i = 0; i < drv->n_bauds; ++i) {
+            if (drv->bauds[i] == stored) continue;
+            if (shs_radar_probe_baud(drv->bauds[i])) { locked = drv->bauds[i]; break; }
+        }
+    }
+
+    if (locked == 0) {
+        ESP_LOGW(SHS_TAG, "No %s frames at any baud, staying at %u", drv->name, (unsigned)stored);
+        uart_set_baudrate(SHS_RADAR_UART_NUM, stored);
+    } else {
+        ESP_LOGI(SHS_TAG, "%s locked at %u baud", drv->name, (unsigned)locked);
+
+        if (locked == drv->upgrade_baud) {
+            *upgrade = true;    /* running there already, whatever failed before */
+        } else if (*upgrade && drv->set_baud && drv->upgrade_baud) {
+            /* each step is ACKed at the old rate; set_baud returns after the restart */
+            esp_err_t err = drv->set_baud(drv->upgrade_baud);
+            if (err == ESP_OK && shs_radar_probe_baud(drv->upgrade_baud)) {
+                locked = drv->upgrade_baud;
+                ESP_LOGI(SHS_TAG, "%s switched to %u baud", drv->name, (unsigned)locked);
+            } else {
+                *upgrade = false;
+                ESP_LOGW(SHS_TAG, "%s baud switch to %u failed (%s), keeping %u", drv->name,
+                         (unsigned)drv->upgrade_baud, esp_err_to_name(err == ESP_OK ? ESP_ERR_TIMEOUT : err),
+                         (unsigned)locked);
+                if (!shs_radar_probe_baud(locked)) {
+                    ESP_LOGW(SHS_TAG, "%s silent after baud switch, keeping %u", drv->name, (unsigned)locked);
+                }
+            }
+        }
+    }
+
+    /* probe noise at wrong rates is not a link-quality signal */
+    shs_rx_inline = false;
+    memset(&shs_radar_stats, 0, sizeof(shs_radar_stats));
+    shs_radar_flush_uart_events();
+    return locked;
+}
+
+/* ---------------- Helpers ---------------- */
+uint32_t shs_isqrt(uint32_t v)
+{
+    uint32_t r = 0, bit = 1UL << 30;
+    while (bit > v) bit >>= 2;
+    while (bit) {
+        if (v >= r + bit) { v -= r + bit; r = (r >> 1) + bit; } else { r >>= 1; }
+        bit >>= 2;
+    }
+    return r;
+}
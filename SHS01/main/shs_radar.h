@@ -0,0 +1,248 @@
+/*
+ * SPDX-FileCopyrightText: 2021-2025
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+#ifndef SHS_RADAR_H
+#define SHS_RADAR_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+
+#include "sdkconfig.h"
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "driver/uart.h"
+#include "driver/gpio.h"
+
+/* ---------------- Radar UART ---------------- */
+#define SHS_RADAR_UART_NUM              (UART_NUM_1)
+#define SHS_RADAR_UART_RX_PIN           (GPIO_NUM_4)
+#define SHS_RADAR_UART_TX_PIN           (GPIO_NUM_5)
+
+/* Radar OUT (presence) pin; -1 when not wired */
+#ifdef CONFIG_SHS_RADAR_OUT_GPIO
+#define SHS_RADAR_OUT_GPIO              (CONFIG_SHS_RADAR_OUT_GPIO)
+#else
+#define SHS_RADAR_OUT_GPIO              (-1)
+#endif
+#if SHS_RADAR_OUT_GPIO == 4 || SHS_RADAR_OUT_GPIO == 5 || SHS_RADAR_OUT_GPIO == 9 || SHS_RADAR_OUT_GPIO >= 24
+#error "SHS_RADAR_OUT_GPIO collides with the radar UART (4/5), BOOT button (9) or SPI flash (24..30)"
+#endif
+
+/* Increase buffers for robustness under bursty frames */
+#define SHS_UART_ACC_BUF_SIZE           (1024)  /* RX ring size (power of two) */
+#define SHS_UART_TX_BUF_SIZE            (256)   /* writes return once queued; > longest command */
+#define SHS_UART_EVT_QUEUE_LEN          (16)    /* UART driver event queue depth */
+#define SHS_UART_PATTERN_QUEUE_LEN      (16)    /* pending frame-end pattern positions */
+
+/* Pattern detector: one frame-end byte (per driver) wakes the parser */
+#define SHS_UART_PATTERN_CHR_TOUT       (9)     /* baud cycles, IDF default */
+#define SHS_UART_PATTERN_POST_IDLE      (0)
+#define SHS_UART_PATTERN_PRE_IDLE       (0)
+
+/* Baud negotiation: defaults for a ~10 Hz report stream (see probe_ms/probe_frames) */
+#define SHS_RADAR_BAUD_PROBE_MS         400     /* ~4 report periods per rate */
+#define SHS_RADAR_BAUD_PROBE_FRAMES     2       /* valid frames needed to lock */
+#define SHS_RADAR_RESTART_MS            1000    /* module boot time after restart */
+
+/* Command transactions: each attempt waits this long for the matching ACK */
+#define SHS_RADAR_CMD_TIMEOUT_MS        300
+#define SHS_RADAR_CMD_ATTEMPTS          3
+#define SHS_RADAR_ACK_MAX_DATA          40      /* ACK bytes kept after the status word */
+#define SHS_RADAR_CMD_STAT_SLOTS        12      /* distinct command words with latency stats */
+
+/* Largest payload kept for duplicate-frame detection */
+#define SHS_RADAR_MAX_PAYLOAD_LEN       64
+
+/* Per-gate arrays are sized for the selected model */
+#if CONFIG_SHS_RADAR_LD2412
+#define SHS_RADAR_MAX_GATES             14
+#else
+#define SHS_RADAR_MAX_GATES             9
+#endif
+
+/* ---------------- Report ---------------- */
+#define SHS_RADAR_STATE_MOVING          0x01
+#define SHS_RADAR_STATE_STATIC          0x02
+
+/* Target report, decoded once per frame by the driver */
+typedef struct {
+    uint8_t  target_state;      /* SHS_RADAR_STATE_* bits */
+    uint8_t  moving_energy;     /* 0..100 */
+    uint8_t  static_energy;     /* 0..100 */
+    uint16_t moving_dist_cm;
+    uint16_t static_dist_cm;
+    uint16_t detect_dist_cm;
+
+    /* per-gate energies; n_gates == 0 when the frame carries none */
+    uint8_t  n_gates;
+    uint8_t  mv_max_gate;
+    uint8_t  st_max_gate;
+    uint8_t  light;
+    uint8_t  out_pin;
+    uint8_t  mv_gate_energy[SHS_RADAR_MAX_GATES];
+    uint8_t  st_gate_energy[SHS_RADAR_MAX_GATES];
+} shs_radar_report_t;
+
+/* Parser statistics (monotonic since boot) */
+typedef struct {
+    uint32_t good_frames;       /* validated and processed */
+    uint32_t bad_frames;        /* header found, length/type/marker check failed */
+    uint32_t resyncs;           /* header searches that had to skip bytes */
+    uint32_t dropped_bytes;     /* bytes discarded outside valid frames */
+    uint32_t duplicate_frames;  /* valid frames identical to the previous one (not processed) */
+    uint32_t cmd_failures;      /* commands that were NAKed or never ACKed */
+    uint32_t cmd_retries;       /* re-sends after an ACK timeout */
+    uint32_t cmd_rtt_max_ms;    /* slowest ACK seen */
+    uint32_t link_losses;       /* frames stopped for longer than the stale limit */
+    uint32_t link_recoveries;   /* watchdog recovery steps issued */
+    uint32_t drift_events;      /* read-backs that found the module config changed */
+} shs_radar_stats_t;
+
+/* Command ACK, as matched by the driver's parser */
+typedef struct {
+    uint16_t cmd;               /* command word without the ACK bit */
+    uint16_t status;            /* 0 = success */
+    uint8_t  len;               /* bytes in data */
+    uint8_t  data[SHS_RADAR_ACK_MAX_DATA];
+} shs_radar_ack_t;
+
+/* Round-trip statistics per command word */
+typedef struct {
+    uint16_t cmd;
+    uint16_t last_ms;
+    uint16_t max_ms;
+    uint32_t ok;
+    uint32_t failed;
+} shs_radar_cmd_stat_t;
+
+/* ---------------- Configuration ---------------- */
+typedef struct {
+    uint8_t  moving_sens;       /* 0..100 */
+    uint8_t  static_sens;       /* 0..100 */
+    uint16_t moving_max_gate;
+    uint16_t static_max_gate;
+    uint16_t no_one_sec;        /* module-side unoccupied delay */
+    uint8_t  fine_res;          /* 1: SHS_RADAR_GATE_CM_FINE gates, 0: SHS_RADAR_GATE_CM */
+
+    /* per-gate thresholds 1..100; 0 = use the global sensitivity */
+    uint8_t  mv_gate_thr[SHS_RADAR_MAX_GATES];
+    uint8_t  st_gate_thr[SHS_RADAR_MAX_GATES];
+} shs_radar_cfg_t;
+
+/* apply_config() selectors */
+#define SHS_RADAR_CFG_SENS              (1U << 0)
+#define SHS_RADAR_CFG_PARAMS            (1U << 1)
+#define SHS_RADAR_CFG_GATE_THR          (1U << 2)
+#define SHS_RADAR_CFG_RES               (1U << 3)
+#define SHS_RADAR_CFG_ALL               (SHS_RADAR_CFG_SENS | SHS_RADAR_CFG_PARAMS | SHS_RADAR_CFG_GATE_THR | SHS_RADAR_CFG_RES)
+
+/* Gate size: every driver uses the coarse scale unless fine_res is selected */
+#define SHS_RADAR_GATE_CM               75
+#define SHS_RADAR_GATE_CM_FINE          20
+
+typedef void (*shs_radar_report_cb_t)(const shs_radar_report_t *rpt);
+
+/* recover() steps, in escalation order */
+#define SHS_RADAR_RECOVER_END_CONFIG    1   /* leave a config mode that stopped the stream */
+#define SHS_RADAR_RECOVER_RESTART       2   /* restart the module (shadowed config is forgotten) */
+
+/* ---------------- Driver interface ----------------
+ * Exactly one driver is linked, chosen by CONFIG_SHS_RADAR_*. Drivers parse
+ * from the shared RX ring in place and own their wire protocol. */
+typedef struct {
+    const char     *name;
+    uint8_t         max_gate;           /* highest gate index */
+    uint8_t         min_static_gate;    /* lowest allowed static max gate */
+    uint8_t         frame_end_chr;      /* UART pattern byte that closes a frame */
+    bool            per_gate_thr;       /* honours cfg->*_gate_thr */
+    bool            fine_res;           /* honours cfg->fine_res */
+    bool            has_distance;       /* reports target distances (zones, tracking) */
+
+    uint32_t        default_baud;
+    const uint32_t *bauds;              /* probe candidates */
+    size_t          n_bauds;
+    uint32_t        upgrade_baud;       /* 0 = keep the detected rate */
+    uint16_t        probe_ms;           /* listen this long per candidate rate ... */
+    uint8_t         probe_frames;       /* ... for this many valid frames */
+
+    esp_err_t (*set_baud)(uint32_t baud); /* switch module rate, restart, wait for it; may be NULL */
+    void (*init)(void);                 /* one-time module setup once the link is up */
+    void (*feed)(shs_radar_report_cb_t on_report);  /* parse buffered RX bytes */
+    esp_err_t (*apply_config)(const shs_radar_cfg_t *cfg, uint32_t what);
+    esp_err_t (*recover)(uint8_t step); /* link watchdog action; may be NULL */
+    esp_err_t (*verify)(bool *drift);   /* re-read module config into the shadow; may be NULL */
+} shs_radar_driver_t;
+
+extern const shs_radar_driver_t shs_radar_driver;
+extern shs_radar_stats_t shs_radar_stats;
+
+/* ---------------- RX ring (shared by all drivers) ----------------
+ * UART bytes are read straight into the ring; frames are parsed in place
+ * (including ones that wrap) and consumed by advancing rd. Indices are
+ * free-running, so (wr - rd) is the fill level. */
+#define SHS_RX_RING_MASK                (SHS_UART_ACC_BUF_SIZE - 1)
+
+extern uint8_t shs_rx_ring[SHS_UART_ACC_BUF_SIZE];
+extern size_t  shs_rx_rd;
+extern size_t  shs_rx_wr;
+
+static inline size_t shs_rx_used(void) { return shs_rx_wr - shs_rx_rd; }
+static inline uint8_t shs_rx_at(size_t off) { return shs_rx_ring[(shs_rx_rd + off) & SHS_RX_RING_MASK]; }
+static inline void shs_rx_consume(size_t n) { shs_rx_rd += n; }
+static inline uint16_t shs_rx_le16(size_t off) { return (uint16_t)shs_rx_at(off) | ((uint16_t)shs_rx_at(off + 1) << 8); }
+
+/* Skip n bytes that could not be part of a valid frame */
+static inline void shs_rx_discard(size_t n)
+{
+    shs_rx_consume(n);
+    shs_radar_stats.dropped_bytes += n;
+}
+
+/* Compare len ring bytes at off with the last processed payload; remember them if different */
+bool shs_radar_payload_repeat(size_t off, uint16_t len);
+/* Force the next frame through processing (e.g. after a config change) */
+void shs_radar_fp_invalidate(void);
+
+/* ---------------- Link ---------------- */
+esp_err_t shs_radar_uart_init(uint32_t baud);
+/* Probe candidate rates (stored one first); returns locked rate or 0. With
+ * *upgrade set, switch to the driver's upgrade rate; *upgrade is cleared if
+ * that switch failed, so the caller can skip it on later boots. Command
+ * ACKs are parsed inline, so set_baud() may use shs_radar_cmd_xfer(). */
+uint32_t shs_radar_baud_negotiate(uint32_t stored, bool *upgrade);
+/* Block up to wait for a UART event; parse complete frames through the driver */
+void shs_radar_poll(TickType_t wait, shs_radar_report_cb_t on_report);
+/* Make a blocked shs_radar_poll() return early (task context, e.g. timer callbacks) */
+void shs_radar_wake(void);
+/* Raw TX for drivers */
+void shs_radar_write(const uint8_t *buf, size_t len);
+
+/* ---------------- OUT pin ----------------
+ * Edges wake shs_radar_poll(), which calls on_change from the radar task. */
+typedef void (*shs_radar_out_cb_t)(void);
+/* Call after shs_radar_uart_init(); no-op when SHS_RADAR_OUT_GPIO < 0 */
+esp_err_t shs_radar_out_pin_init(shs_radar_out_cb_t on_change);
+/* Current pin level; false when not wired */
+bool shs_radar_out_level(void);
+
+/* ---------------- Command transactions ----------------
+ * The caller sends a frame and blocks until the driver's parser (running in
+ * the radar task) posts the ACK for that command word. Must not be called
+ * from the radar task itself. */
+/* Send frame, wait for the ACK of cmd; retries on timeout. ESP_OK, ESP_FAIL (NAK) or ESP_ERR_TIMEOUT */
+esp_err_t shs_radar_cmd_xfer(uint16_t cmd, const uint8_t *frame, size_t len, shs_radar_ack_t *ack);
+/* Parser hook: an ACK frame arrived */
+void shs_radar_ack_post(const shs_radar_ack_t *ack);
+/* Latency table (n entries) */
+const shs_radar_cmd_stat_t *shs_radar_cmd_stats(size_t *n);
+/* Transactions sent so far; a change across a call means it wrote to the module */
+uint32_t shs_radar_cmd_count(void);
+
+/* ---------------- Helpers ---------------- */
+/* Integer square root (floor), for energy standard deviations */
+uint32_t shs_isqrt(uint32_t v);
+
+#endif /* SHS_RADAR_H */
@@ -0,0 +1,376 @@
+/*
+ * SPDX-FileCopyrightText: 2021-2025
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+#include <stdbool.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "esp_log.h"
+
+#include "shs_radar.h"
+#include "shs_radar_ld24xx.h"
+#include "shs_radar_ld2410.h"
+
+_Static_assert(SHS_LD2410_GATES <= SHS_RADAR_MAX_GATES, "SHS_RADAR_MAX_GATES too small for LD2410");
+
+static const char *SHS_TAG = "LD2410";
+
+/* ---------------- Config shadow ----------------
+ * Last values the module acknowledged; only fields that differ are written.
+ * A field is unknown at boot and after a failed write. Per-gate sensitivities
+ * live in mv_gate_thr/st_gate_thr as the module holds them (no 0 = global). */
+#define SHS_LD2410_SH_MV_GATE   (1U << 0)
+#define SHS_LD2410_SH_ST_GATE   (1U << 1)
+#define SHS_LD2410_SH_NO_ONE    (1U << 2)
+#define SHS_LD2410_SH_RES       (1U << 3)
+#define SHS_LD2410_SH_GATES_ALL ((1U << SHS_LD2410_GATES) - 1)
+
+static shs_radar_cfg_t shs_ld2410_shadow;
+static uint32_t        shs_ld2410_shadow_known = 0;
+static uint32_t        shs_ld2410_gate_known   = 0;     /* bit g: sensitivities of gate g */
+static bool            shs_ld2410_res_supported = false; /* firmware answered read-resolution */
+
+static inline bool shs_ld2410_differs(uint32_t field, uint32_t want, uint32_t have)
+{
+    return !(shs_ld2410_shadow_known & field) || want != have;
+}
+
+/* One (word, LE32 value) pair of the set-params / set-sensitivity commands */
+static int shs_ld2410_param_word(uint8_t *p, uint16_t word, uint16_t value)
+{
+    p[0] = (uint8_t)(word & 0xFF);  p[1] = (uint8_t)((word >> 8) & 0xFF);
+    p[2] = (uint8_t)(value & 0xFF); p[3] = (uint8_t)((value >> 8) & 0xFF);
+    p[4] = 0x00; p[5] = 0x00;
+    return 6;
+}
+
+/* Set-sensitivity for one gate, or every gate with SHS_LD2410_GATE_ALL */
+static esp_err_t shs_ld2410_set_gate_sens(uint16_t gate, uint8_t mv, uint8_t st)
+{
+    uint8_t args[(2+4)*3]; int n = 0;
+    n += shs_ld2410_param_word(&args[n], SHS_LD2410_PW_SENS_GATE, gate);
+    n += shs_ld2410_param_word(&args[n], SHS_LD2410_PW_SENS_MOVE, mv);
+    n += shs_ld2410_param_word(&args[n], SHS_LD2410_PW_SENS_STATIC, st);
+    return shs_ld24xx_cmd(SHS_LD2410_CMD_SET_SENSITIVITY, args, n, NULL);
+}
+
+/* ---------------- Frame parser ---------------- */
+
+/* Decode the target report of the frame at the ring read position */
+static void shs_ld2410_decode_report(uint16_t payload_len, shs_radar_report_t *out)
+{
+    memset(out, 0, sizeof(*out));
+    out->target_state = shs_rx_at(SHS_LD24XX_OFF_STATE);
+    if (payload_len < SHS_LD2410_BASIC_PAYLOAD_LEN) return;
+
+    out->moving_dist_cm = shs_rx_le16(SHS_LD24XX_OFF_MV_DIST);
+    out->moving_energy  = shs_rx_at(SHS_LD24XX_OFF_MV_ENERGY);
+    out->static_dist_cm = shs_rx_le16(SHS_LD24XX_OFF_ST_DIST);
+    out->static_energy  = shs_rx_at(SHS_LD24XX_OFF_ST_ENERGY);
+    out->detect_dist_cm = shs_rx_le16(SHS_LD2410_OFF_DET_DIST);
+
+    if (shs_rx_at(SHS_LD24XX_OFF_TYPE) != SHS_LD24XX_TYPE_ENGINEERING) return;
+
+    /* Gate counts come from the frame; anything past gate 8 is ignored */
+    unsigned n_mv = shs_rx_at(SHS_LD2410_OFF_ENG_MV_MAX_GATE) + 1U;
+    unsigned n_st = shs_rx_at(SHS_LD2410_OFF_ENG_ST_MAX_GATE) + 1U;
+    size_t need = (SHS_LD2410_OFF_ENG_GATES - SHS_LD24XX_OFF_TYPE) + n_mv + n_st + SHS_LD2410_ENG_TRAILER_LEN;
+    if (payload_len < need) return;
+
+    out->n_gates     = SHS_LD2410_GATES;
+    out->mv_max_gate = (uint8_t)(n_mv - 1);
+    out->st_max_gate = (uint8_t)(n_st - 1);
+    size_t off = SHS_LD2410_OFF_ENG_GATES;
+    for (unsigned g = 0; g < n_mv; ++g, ++off) {
+        if (g < SHS_LD2410_GATES) out->mv_gate_energy[g] = shs_rx_at(off);
+    }
+    for (unsigned g = 0; g < n_st; ++g, ++off) {
+        if (g < SHS_LD2410_GATES) out->st_gate_energy[g] = shs_rx_at(off);
+    }
+    out->light   = shs_rx_at(off);
+    out->out_pin = shs_rx_at(off + 1);
+}
+
+static const shs_ld24xx_model_t shs_ld2410_model = {
+    .basic_payload_len = SHS_LD2410_BASIC_PAYLOAD_LEN,
+    .decode            = shs_ld2410_decode_report,
+};
+
+static void shs_ld2410_feed(shs_radar_report_cb_t on_report)
+{
+    shs_ld24xx_feed(&shs_ld2410_model, on_report);
+}
+
+/* ---------------- Boot read-back ---------------- */
+/* Seed the shadow from a read-params ACK so unchanged settings are not rewritten */
+static bool shs_ld2410_shadow_load(const shs_radar_ack_t *ack)
+{
+    const uint8_t *d = ack->data;
+    if (ack->len < SHS_LD2410_RP_ACK_LEN || d[SHS_LD2410_RP_HEAD] != SHS_LD24XX_RPT_HEAD) return false;
+
+    shs_ld2410_shadow.moving_max_gate = d[SHS_LD2410_RP_MV_MAX_GATE];
+    shs_ld2410_shadow.static_max_gate = d[SHS_LD2410_RP_ST_MAX_GATE];
+    shs_ld2410_shadow.no_one_sec      = (uint16_t)d[SHS_LD2410_RP_NO_ONE] | ((uint16_t)d[SHS_LD2410_RP_NO_ONE + 1] << 8);
+    shs_ld2410_shadow_known |= SHS_LD2410_SH_MV_GATE | SHS_LD2410_SH_ST_GATE | SHS_LD2410_SH_NO_ONE;
+
+    for (int g = 0; g < SHS_LD2410_GATES; ++g) {
+        shs_ld2410_shadow.mv_gate_thr[g] = d[SHS_LD2410_RP_MV_SENS + g];
+        shs_ld2410_shadow.st_gate_thr[g] = d[SHS_LD2410_RP_ST_SENS + g];
+    }
+    shs_ld2410_gate_known = SHS_LD2410_SH_GATES_ALL;
+
+    ESP_LOGI(SHS_TAG, "Module params: move_gate=%u, static_gate=%u, no_one=%us",
+             (unsigned)shs_ld2410_shadow.moving_max_gate, (unsigned)shs_ld2410_shadow.static_max_gate,
+             (unsigned)shs_ld2410_shadow.no_one_sec);
+    for (int g = 0; g < SHS_LD2410_GATES; ++g) {
+        ESP_LOGD(SHS_TAG, "  gate %d: move=%u, static=%u", g,
+                 (unsigned)shs_ld2410_shadow.mv_gate_thr[g], (unsigned)shs_ld2410_shadow.st_gate_thr[g]);
+    }
+    return true;
+}
+
+/* Distance resolution into the shadow; false on firmware without it */
+static bool shs_ld2410_read_resolution(void)
+{
+    shs_radar_ack_t ack;
+    if (shs_ld24xx_cmd(SHS_LD2410_CMD_READ_RESOLUTION, NULL, 0, &ack) != ESP_OK || ack.len < SHS_LD2410_RES_ACK_LEN) {
+        return false;
+    }
+    uint16_t res = (uint16_t)ack.data[0] | ((uint16_t)ack.data[1] << 8);
+    shs_ld2410_shadow.fine_res = (res == SHS_LD2410_RES_020);
+    shs_ld2410_shadow_known |= SHS_LD2410_SH_RES;
+    return true;
+}
+
+/* ---------------- Driver ops ---------------- */
+static void shs_ld2410_init(void)
+{
+    shs_radar_ack_t ack;
+    uint8_t mac[SHS_LD24XX_MAC_ACK_LEN];
+    bool have_mac = false;
+
+    /* one read-only session: firmware, module identity, current parameters */
+    esp_err_t err = shs_ld24xx_begin_config();
+    if (err == ESP_OK) {
+        have_mac = shs_ld24xx_identify(mac);
+
+        if (shs_ld24xx_cmd(SHS_LD2410_CMD_READ_PARAMS, NULL, 0, &ack) == ESP_OK) (void)shs_ld2410_shadow_load(&ack);
+
+        if (shs_ld2410_read_resolution()) {
+            shs_ld2410_res_supported = true;
+            ESP_LOGI(SHS_TAG, "Distance resolution %s m", shs_ld2410_shadow.fine_res ? "0.2" : "0.75");
+        } else {
+            ESP_LOGI(SHS_TAG, "Firmware without distance resolution control, 0.75 m gates");
+        }
+        shs_ld24xx_end_config();
+    }
+
+    bool restarted = shs_ld24xx_ble_off_once(mac, have_mac);
+
+    /* engineering mode does not survive a restart; otherwise trust the frames seen so far */
+    bool eng_now = restarted ? false : shs_ld24xx_eng_seen;
+    if (eng_now != SHS_LD2410_ENGINEERING_MODE) {
+        shs_ld24xx_apply_engineering_mode(SHS_LD2410_ENGINEERING_MODE);
+    }
+}
+
+/* Everything that differs from the shadow goes out in one config session */
+static esp_err_t shs_ld2410_apply_config(const shs_radar_cfg_t *cfg, uint32_t what)
+{
+    const shs_radar_cfg_t *sh = &shs_ld2410_shadow;
+
+    /* belt-and-suspenders clamp */
+    uint8_t  mv      = shs_clamp_u8(cfg->moving_sens, 0, 100);
+    uint8_t  st      = shs_clamp_u8(cfg->static_sens, 0, 100);
+    uint16_t mv_gate = shs_clamp_u16(cfg->moving_max_gate, 0, SHS_LD2410_GATES - 1);
+    uint16_t st_gate = shs_clamp_u16(cfg->static_max_gate, SHS_LD2410_MIN_STATIC_GATE, SHS_LD2410_GATES - 1);
+    uint16_t no_one  = cfg->no_one_sec; /* 0..65535 */
+
+    /* effective per-gate values; static gates below MIN_STATIC_GATE are fixed by the module */
+    uint8_t  gate_mv[SHS_LD2410_GATES], gate_st[SHS_LD2410_GATES];
+    uint32_t dirty = 0;
+    bool     uniform = true;
+    if (what & (SHS_RADAR_CFG_SENS | SHS_RADAR_CFG_GATE_THR)) {
+        for (int g = 0; g < SHS_LD2410_GATES; ++g) {
+            gate_mv[g] = shs_clamp_u8(cfg->mv_gate_thr[g] ? cfg->mv_gate_thr[g] : mv, 0, 100);
+            gate_st[g] = shs_clamp_u8(cfg->st_gate_thr[g] ? cfg->st_gate_thr[g] : st, 0, 100);
+            bool st_differs = g >= SHS_LD2410_MIN_STATIC_GATE && gate_st[g] != sh->st_gate_thr[g];
+            if (!(shs_ld2410_gate_known & (1U << g)) || gate_mv[g] != sh->mv_gate_thr[g] || st_differs) {
+                dirty |= 1U << g;
+            }
+            if (gate_mv[g] != gate_mv[0] ||
+                (g > SHS_LD2410_MIN_STATIC_GATE && gate_st[g] != gate_st[SHS_LD2410_MIN_STATIC_GATE])) {
+                uniform = false;
+            }
+        }
+    }
+    bool sens = dirty != 0;
+
+    /* the module reads SET_PARAMS as one record: any change sends all three words */
+    uint8_t params[(2+4)*3]; int o = 0;
+    const uint32_t param_fields = SHS_LD2410_SH_MV_GATE | SHS_LD2410_SH_ST_GATE | SHS_LD2410_SH_NO_ONE;
+    if ((what & SHS_RADAR_CFG_PARAMS) &&
+        (shs_ld2410_differs(SHS_LD2410_SH_MV_GATE, mv_gate, sh->moving_max_gate) ||
+         shs_ld2410_differs(SHS_LD2410_SH_ST_GATE, st_gate, sh->static_max_gate) ||
+         shs_ld2410_differs(SHS_LD2410_SH_NO_ONE, no_one, sh->no_one_sec))) {
+        o += shs_ld2410_param_word(&params[o], SHS_LD2410_PW_MAX_MOVE_GATE, mv_gate);
+        o += shs_ld2410_param_word(&params[o], SHS_LD2410_PW_MAX_STATIC_GATE, st_gate);
+        o += shs_ld2410_param_word(&params[o], SHS_LD2410_PW_NO_ONE_DURATION, no_one);
+    }
+
+    /* resolution: only on firmware that reported it at boot */
+    bool fine = cfg->fine_res != 0;
+    bool res  = false;
+    if (what & SHS_RADAR_CFG_RES) {
+        if (shs_ld2410_res_supported) {
+            res = shs_ld2410_differs(SHS_LD2410_SH_RES, fine, shs_ld2410_shadow.fine_res);
+        } else if (fine) {
+            ESP_LOGW(SHS_TAG, "0.2 m resolution not supported by this module firmware");
+        }
+    }
+
+    if (!sens && o == 0 && !res) {
+        ESP_LOGD(SHS_TAG, "Config unchanged, no session");
+        return ESP_OK;
+    }
+
+    esp_err_t err = shs_ld24xx_begin_config();
+
+    if (err == ESP_OK && sens) {
+        int writes = 0;
+        bool all_at_once = uniform && dirty == SHS_LD2410_SH_GATES_ALL;
+        if (all_at_once) {
+            /* every gate changes to the same value: one write for all */
+            err = shs_ld2410_set_gate_sens(SHS_LD2410_GATE_ALL, gate_mv[0], gate_st[SHS_LD2410_MIN_STATIC_GATE]);
+            writes = 1;
+            if (err == ESP_OK) {
+                for (int g = 0; g < SHS_LD2410_GATES; ++g) {
+                    shs_ld2410_shadow.mv_gate_thr[g] = gate_mv[0];
+                    shs_ld2410_shadow.st_gate_thr[g] = gate_st[SHS_LD2410_MIN_STATIC_GATE];
+                }
+                shs_ld2410_gate_known = SHS_LD2410_SH_GATES_ALL;
+            } else {
+                shs_ld2410_gate_known = 0;
+            }
+        } else {
+            for (int g = 0; g < SHS_LD2410_GATES && err == ESP_OK; ++g) {
+                if (!(dirty & (1U << g))) continue;
+                err = shs_ld2410_set_gate_sens((uint16_t)g, gate_mv[g], gate_st[g]);
+                writes++;
+                if (err == ESP_OK) {
+                    shs_ld2410_shadow.mv_gate_thr[g] = gate_mv[g];
+                    shs_ld2410_shadow.st_gate_thr[g] = gate_st[g];
+                    shs_ld2410_gate_known |= 1U << g;
+                } else {
+                    shs_ld2410_gate_known &= ~(1U << g);
+                }
+            }
+        }
+        if (err == ESP_OK) {
+            ESP_LOGI(SHS_TAG, "Applied sensitivity: %u gate(s) in %d write(s)%s",
+                     (unsigned)__builtin_popcount(dirty), writes, all_at_once ? " (all gates)" : "");
+        }
+    }
+
+    if (err == ESP_OK && o > 0) {
+        err = shs_ld24xx_cmd(SHS_LD2410_CMD_SET_PARAMS, params, o, NULL);
+        if (err == ESP_OK) {
+            shs_ld2410_shadow.moving_max_gate = mv_gate;
+            shs_ld2410_shadow.static_max_gate = st_gate;
+            shs_ld2410_shadow.no_one_sec      = no_one;
+            shs_ld2410_shadow_known |= param_fields;
+            ESP_LOGI(SHS_TAG, "Applied params: move_gate=%u, static_gate=%u, no_one=%us",
+                     (unsigned)mv_gate, (unsigned)st_gate, (unsigned)no_one);
+        } else {
+            shs_ld2410_shadow_known &= ~param_fields;
+        }
+    }
+
+    if (err == ESP_OK && res) {
+        const uint8_t args[] = { fine ? (SHS_LD2410_RES_020 & 0xFF) : (SHS_LD2410_RES_075 & 0xFF), 0x00 };
+        err = shs_ld24xx_cmd(SHS_LD2410_CMD_SET_RESOLUTION, args, sizeof(args), NULL);
+        if (err == ESP_OK) {
+            shs_ld2410_shadow.fine_res = fine;
+            shs_ld2410_shadow_known |= SHS_LD2410_SH_RES;
+            ESP_LOGI(SHS_TAG, "Applied distance resolution %s m", fine ? "0.2" : "0.75");
+
+            /* the new gate size needs a restart, which also leaves config mode */
+            err = shs_ld24xx_restart_in_session();
+            if (err != ESP_OK) {
+                shs_ld2410_shadow_known &= ~SHS_LD2410_SH_RES;  /* retry the write + restart next time */
+                return err;
+            }
+            if (SHS_LD2410_ENGINEERING_MODE) shs_ld24xx_apply_engineering_mode(true);
+            return ESP_OK;
+        }
+        shs_ld2410_shadow_known &= ~SHS_LD2410_SH_RES;
+    }
+
+    /* end is sent even on failure so the module leaves config mode */
+    esp_err_t end = shs_ld24xx_end_config();
+    if (err == ESP_OK) err = end;
+    if (err != ESP_OK) ESP_LOGW(SHS_TAG, "Config not fully applied (%s)", esp_err_to_name(err));
+    return err;
+}
+
+/* Re-read the module into the shadow so the next apply diffs against what it
+ * really holds; drift = it had fallen back to basic frames */
+static esp_err_t shs_ld2410_verify(bool *drift)
+{
+    shs_radar_ack_t ack;
+
+    esp_err_t err = shs_ld24xx_begin_config();
+    if (err == ESP_OK) {
+        err = shs_ld24xx_cmd(SHS_LD2410_CMD_READ_PARAMS, NULL, 0, &ack);
+        if (err == ESP_OK && !shs_ld2410_shadow_load(&ack)) err = ESP_ERR_INVALID_RESPONSE;
+        if (err == ESP_OK && shs_ld2410_res_supported && !shs_ld2410_read_resolution()) err = ESP_ERR_INVALID_RESPONSE;
+    }
+    esp_err_t end = shs_ld24xx_end_config();
+    if (err == ESP_OK) err = end;
+    if (err != ESP_OK) return err;
+
+    /* a reset module also streams basic frames again */
+    bool d = false;
+    if (shs_ld24xx_eng_seen != SHS_LD2410_ENGINEERING_MODE) {
+        shs_ld24xx_apply_engineering_mode(SHS_LD2410_ENGINEERING_MODE);
+        d = true;
+    }
+    *drift = d;
+    return ESP_OK;
+}
+
+/* Link watchdog steps; a restart forgets the shadow */
+static esp_err_t shs_ld2410_recover(uint8_t step)
+{
+    if (step == SHS_RADAR_RECOVER_RESTART) {
+        shs_ld2410_shadow_known = 0;
+        shs_ld2410_gate_known   = 0;
+    }
+    return shs_ld24xx_recover(step, SHS_LD2410_ENGINEERING_MODE);
+}
+
+static const uint32_t shs_ld2410_bauds[] = SHS_LD2410_BAUD_CANDIDATES;
+
+const shs_radar_driver_t shs_radar_driver = {
+    .name            = "LD2410",
+    .max_gate        = SHS_LD2410_GATES - 1,
+    .min_static_gate = SHS_LD2410_MIN_STATIC_GATE,
+    .frame_end_chr   = SHS_LD24XX_TAIL_RX3,
+    .per_gate_thr    = true,
+    .fine_res        = true,
+    .has_distance    = true,
+    .default_baud    = SHS_LD2410_BAUD_DEFAULT,
+    .bauds           = shs_ld2410_bauds,
+    .n_bauds         = sizeof(shs_ld2410_bauds) / sizeof(shs_ld2410_bauds[0]),
+    .upgrade_baud    = SHS_LD2410_BAUD_UPGRADE ? SHS_LD2410_BAUD_TARGET : 0,
+    .probe_ms        = SHS_RADAR_BAUD_PROBE_MS,
+    .probe_frames    = SHS_RADAR_BAUD_PROBE_FRAMES,
+    .set_baud        = shs_ld24xx_set_module_baud,
+    .init            = shs_ld2410_init,
+    .feed            = shs_ld2410_feed,
+    .apply_config    = shs_ld2410_apply_config,
+    .recover         = shs_ld2410_recover,
+    .verify          = shs_ld2410_verify,
+};
@@ -0,0 +1,62 @@
+/*
+ * SPDX-FileCopyrightText: 2021-2025
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+#ifndef SHS_RADAR_LD2410_H
+#define SHS_RADAR_LD2410_H
+
+/* ---------------- LD2410C constants ----------------
+ * Framing, session and shared commands: shs_radar_ld24xx.h */
+
+/* Report frame layout (byte offsets from the F4 header, after ST_ENERGY) */
+#define SHS_LD2410_OFF_DET_DIST         15  /* LE16 cm */
+#define SHS_LD2410_BASIC_PAYLOAD_LEN    13  /* type..check byte */
+
+/* Engineering-mode extension (follows OFF_DET_DIST) */
+#define SHS_LD2410_OFF_ENG_MV_MAX_GATE  17  /* N: moving gates 0..N follow */
+#define SHS_LD2410_OFF_ENG_ST_MAX_GATE  18  /* M: static gates 0..M follow */
+#define SHS_LD2410_OFF_ENG_GATES        19  /* N+1 moving, then M+1 static energies */
+#define SHS_LD2410_ENG_TRAILER_LEN      4   /* light, OUT pin, 0x55, 0x00 */
+
+#define SHS_LD2410_GATES                9   /* gates 0..8 */
+#define SHS_LD2410_MIN_STATIC_GATE      2
+
+/* Commands */
+#define SHS_LD2410_CMD_SET_PARAMS       0x0060
+#define SHS_LD2410_CMD_READ_PARAMS      0x0061
+#define SHS_LD2410_CMD_SET_SENSITIVITY  0x0064
+#define SHS_LD2410_CMD_SET_RESOLUTION   0x00AA  /* LE16 index; takes effect after a restart */
+#define SHS_LD2410_CMD_READ_RESOLUTION  0x00AB  /* NAKed by firmware without 0.2 m support */
+
+/* ACK data layouts (offsets after the status word) */
+#define SHS_LD2410_RP_HEAD              0   /* 0xAA */
+#define SHS_LD2410_RP_MV_MAX_GATE       2
+#define SHS_LD2410_RP_ST_MAX_GATE       3
+#define SHS_LD2410_RP_MV_SENS           4   /* 9 gates */
+#define SHS_LD2410_RP_ST_SENS           13  /* 9 gates */
+#define SHS_LD2410_RP_NO_ONE            22  /* LE16 s */
+#define SHS_LD2410_RP_ACK_LEN           24
+#define SHS_LD2410_RES_ACK_LEN          2   /* LE16 resolution index */
+
+/* Parameters */
+#define SHS_LD2410_PW_MAX_MOVE_GATE     0x0000
+#define SHS_LD2410_PW_MAX_STATIC_GATE   0x0001
+#define SHS_LD2410_PW_NO_ONE_DURATION   0x0002
+#define SHS_LD2410_PW_SENS_GATE         0x0000  /* set-sensitivity: gate index */
+#define SHS_LD2410_PW_SENS_MOVE         0x0001
+#define SHS_LD2410_PW_SENS_STATIC       0x0002
+#define SHS_LD2410_GATE_ALL             0xFFFF
+#define SHS_LD2410_RES_075              0x0000  /* 0.75 m gates */
+#define SHS_LD2410_RES_020              0x0001  /* 0.2 m gates */
+
+/* Stream per-gate energies (engineering frames) instead of basic reports */
+#define SHS_LD2410_ENGINEERING_MODE     1
+
+/* Baud: candidates to probe, and the rate to switch the module to */
+#define SHS_LD2410_BAUD_DEFAULT         57600
+#define SHS_LD2410_BAUD_CANDIDATES      { 256000, 115200, 57600, 38400, 230400, 460800, 19200, 9600 }
+#define SHS_LD2410_BAUD_UPGRADE         1       /* switch the module to SHS_LD2410_BAUD_TARGET */
+#define SHS_LD2410_BAUD_TARGET          256000
+
+#endif /* SHS_RADAR_LD2410_H */
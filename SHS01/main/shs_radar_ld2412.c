@@ -0,0 +1,294 @@
+/*
+ * SPDX-FileCopyrightText: 2021-2025
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+#include <stdbool.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "esp_log.h"
+
+#include "shs_radar.h"
+#include "shs_radar_ld24xx.h"
+#include "shs_radar_ld2412.h"
+
+_Static_assert(SHS_LD2412_GATES <= SHS_RADAR_MAX_GATES, "SHS_RADAR_MAX_GATES too small for LD2412");
+_Static_assert(SHS_LD2412_GATES <= SHS_RADAR_ACK_MAX_DATA, "SHS_RADAR_ACK_MAX_DATA too small for LD2412 thresholds");
+
+static const char *SHS_TAG = "LD2412";
+
+/* ---------------- Config shadow ----------------
+ * Records as the module holds them, seeded from the read commands at boot
+ * and after each drift check; a record is written only when it differs. A
+ * record is unknown until read and after a failed write. */
+#define SHS_LD2412_SH_BASIC     (1U << 0)
+#define SHS_LD2412_SH_MV_THR    (1U << 1)
+#define SHS_LD2412_SH_ST_THR    (1U << 2)
+
+typedef struct {
+    uint8_t basic[SHS_LD2412_BP_LEN];
+    uint8_t mv_thr[SHS_LD2412_GATES];
+    uint8_t st_thr[SHS_LD2412_GATES];
+} shs_ld2412_shadow_t;
+
+static shs_ld2412_shadow_t shs_ld2412_shadow;
+static uint32_t            shs_ld2412_shadow_known = 0;
+
+static inline bool shs_ld2412_differs(uint32_t field, const uint8_t *want, const uint8_t *have, size_t len)
+{
+    return !(shs_ld2412_shadow_known & field) || memcmp(want, have, len) != 0;
+}
+
+/* Read one record into the shadow (inside an open session) */
+static esp_err_t shs_ld2412_read(uint16_t cmd, uint8_t *have, size_t len, uint32_t field)
+{
+    shs_radar_ack_t ack;
+    esp_err_t err = shs_ld24xx_cmd(cmd, NULL, 0, &ack);
+    if (err == ESP_OK && ack.len < len) err = ESP_ERR_INVALID_RESPONSE;
+    if (err != ESP_OK) {
+        shs_ld2412_shadow_known &= ~field;
+        return err;
+    }
+    memcpy(have, ack.data, len);
+    shs_ld2412_shadow_known |= field;
+    return ESP_OK;
+}
+
+/* Write one record (inside an open session); the shadow follows the ACK */
+static esp_err_t shs_ld2412_write(uint16_t cmd, const uint8_t *want, uint8_t *have, size_t len, uint32_t field)
+{
+    esp_err_t err = shs_ld24xx_cmd(cmd, want, (uint16_t)len, NULL);
+    if (err != ESP_OK) {
+        shs_ld2412_shadow_known &= ~field;
+        return err;
+    }
+    memcpy(have, want, len);
+    shs_ld2412_shadow_known |= field;
+    return ESP_OK;
+}
+
+/* ---------------- Read-back ---------------- */
+/* All three records into the shadow (inside an open session) */
+static esp_err_t shs_ld2412_shadow_read(void)
+{
+    shs_ld2412_shadow_t *sh = &shs_ld2412_shadow;
+    esp_err_t err = shs_ld2412_read(SHS_LD2412_CMD_READ_BASIC, sh->basic, sizeof(sh->basic), SHS_LD2412_SH_BASIC);
+    if (err == ESP_OK) err = shs_ld2412_read(SHS_LD2412_CMD_READ_MV_THR, sh->mv_thr, sizeof(sh->mv_thr), SHS_LD2412_SH_MV_THR);
+    if (err == ESP_OK) err = shs_ld2412_read(SHS_LD2412_CMD_READ_ST_THR, sh->st_thr, sizeof(sh->st_thr), SHS_LD2412_SH_ST_THR);
+    if (err != ESP_OK) return err;
+
+    ESP_LOGI(SHS_TAG, "Module params: gates %u..%u, no_one=%us",
+             (unsigned)sh->basic[SHS_LD2412_BP_MIN_GATE], (unsigned)sh->basic[SHS_LD2412_BP_MAX_GATE],
+             (unsigned)((uint16_t)sh->basic[SHS_LD2412_BP_NO_ONE] | ((uint16_t)sh->basic[SHS_LD2412_BP_NO_ONE + 1] << 8)));
+    for (int g = 0; g < SHS_LD2412_GATES; ++g) {
+        ESP_LOGD(SHS_TAG, "  gate %d: move=%u, static=%u", g, (unsigned)sh->mv_thr[g], (unsigned)sh->st_thr[g]);
+    }
+    return ESP_OK;
+}
+
+/* ---------------- Config records ---------------- */
+/* The module has one range; the tighter channel range is enforced by
+ * disabling that channel's gates past its max gate */
+static void shs_ld2412_build_basic(uint8_t *p, uint16_t mv_gate, uint16_t st_gate, uint16_t no_one)
+{
+    uint16_t max_gate = shs_clamp_u16(mv_gate > st_gate ? mv_gate : st_gate, SHS_LD2412_MIN_GATE, SHS_LD2412_GATES - 1);
+    p[SHS_LD2412_BP_MIN_GATE]   = SHS_LD2412_MIN_GATE;
+    p[SHS_LD2412_BP_MAX_GATE]   = (uint8_t)max_gate;
+    p[SHS_LD2412_BP_NO_ONE]     = (uint8_t)(no_one & 0xFF);
+    p[SHS_LD2412_BP_NO_ONE + 1] = (uint8_t)((no_one >> 8) & 0xFF);
+    p[SHS_LD2412_BP_OUT_POL]    = SHS_LD2412_OUT_ACTIVE_HIGH;
+}
+
+/* Per-gate overrides, else the global value; gates past the channel's range are disabled */
+static void shs_ld2412_build_thresholds(uint8_t *thr, uint8_t global, const uint8_t *gate_thr, uint16_t max_gate)
+{
+    for (uint16_t g = 0; g < SHS_LD2412_GATES; ++g) {
+        uint8_t v = gate_thr[g] ? gate_thr[g] : global;
+        if (v > SHS_LD2412_THR_OFF || g > max_gate) v = SHS_LD2412_THR_OFF;
+        thr[g] = v;
+    }
+}
+
+/* ---------------- Frame parser ---------------- */
+
+/* Decode the target report of the frame at the ring read position */
+static void shs_ld2412_decode_report(uint16_t payload_len, shs_radar_report_t *out)
+{
+    memset(out, 0, sizeof(*out));
+    out->target_state   = shs_rx_at(SHS_LD24XX_OFF_STATE);
+    out->moving_dist_cm = shs_rx_le16(SHS_LD24XX_OFF_MV_DIST);
+    out->moving_energy  = shs_rx_at(SHS_LD24XX_OFF_MV_ENERGY);
+    out->static_dist_cm = shs_rx_le16(SHS_LD24XX_OFF_ST_DIST);
+    out->static_energy  = shs_rx_at(SHS_LD24XX_OFF_ST_ENERGY);
+
+    /* no detection distance on the wire: nearest reported target */
+    if ((out->target_state & SHS_RADAR_STATE_MOVING) &&
+        (!(out->target_state & SHS_RADAR_STATE_STATIC) || out->moving_dist_cm < out->static_dist_cm)) {
+        out->detect_dist_cm = out->moving_dist_cm;
+    } else if (out->target_state & SHS_RADAR_STATE_STATIC) {
+        out->detect_dist_cm = out->static_dist_cm;
+    }
+
+    if (shs_rx_at(SHS_LD24XX_OFF_TYPE) != SHS_LD24XX_TYPE_ENGINEERING) return;
+
+    /* Gate counts come from the frame; anything past gate 13 is ignored */
+    unsigned n_mv = shs_rx_at(SHS_LD2412_OFF_ENG_MV_MAX_GATE) + 1U;
+    unsigned n_st = shs_rx_at(SHS_LD2412_OFF_ENG_ST_MAX_GATE) + 1U;
+    size_t need = (SHS_LD2412_OFF_ENG_GATES - SHS_LD24XX_OFF_TYPE) + n_mv + n_st + SHS_LD2412_ENG_TRAILER_LEN;
+    if (payload_len < need) return;
+
+    out->n_gates     = SHS_LD2412_GATES;
+    out->mv_max_gate = (uint8_t)(n_mv - 1);
+    out->st_max_gate = (uint8_t)(n_st - 1);
+    size_t off = SHS_LD2412_OFF_ENG_GATES;
+    for (unsigned g = 0; g < n_mv; ++g, ++off) {
+        if (g < SHS_LD2412_GATES) out->mv_gate_energy[g] = shs_rx_at(off);
+    }
+    for (unsigned g = 0; g < n_st; ++g, ++off) {
+        if (g < SHS_LD2412_GATES) out->st_gate_energy[g] = shs_rx_at(off);
+    }
+    out->light = shs_rx_at(off);
+}
+
+static const shs_ld24xx_model_t shs_ld2412_model = {
+    .basic_payload_len = SHS_LD2412_BASIC_PAYLOAD_LEN,
+    .decode            = shs_ld2412_decode_report,
+};
+
+static void shs_ld2412_feed(shs_radar_report_cb_t on_report)
+{
+    shs_ld24xx_feed(&shs_ld2412_model, on_report);
+}
+
+/* ---------------- Driver ops ---------------- */
+static void shs_ld2412_init(void)
+{
+    uint8_t mac[SHS_LD24XX_MAC_ACK_LEN];
+    bool have_mac = false;
+
+    /* one read-only session: firmware, module identity, current parameters */
+    esp_err_t err = shs_ld24xx_begin_config();
+    if (err == ESP_OK) {
+        have_mac = shs_ld24xx_identify(mac);
+        err = shs_ld2412_shadow_read();
+        if (err != ESP_OK) ESP_LOGW(SHS_TAG, "Parameter read-back failed (%s)", esp_err_to_name(err));
+        shs_ld24xx_end_config();
+    }
+
+    bool restarted = shs_ld24xx_ble_off_once(mac, have_mac);
+
+    /* engineering mode does not survive a restart; otherwise trust the frames seen so far */
+    bool eng_now = restarted ? false : shs_ld24xx_eng_seen;
+    if (eng_now != SHS_LD2412_ENGINEERING_MODE) {
+        shs_ld24xx_apply_engineering_mode(SHS_LD2412_ENGINEERING_MODE);
+    }
+}
+
+/* Records that differ from the shadow go out in one config session; range
+ * and sensitivity both feed the threshold tables */
+static esp_err_t shs_ld2412_apply_config(const shs_radar_cfg_t *cfg, uint32_t what)
+{
+    shs_ld2412_shadow_t *sh = &shs_ld2412_shadow;
+
+    uint16_t mv_gate = shs_clamp_u16(cfg->moving_max_gate, 0, SHS_LD2412_GATES - 1);
+    uint16_t st_gate = shs_clamp_u16(cfg->static_max_gate, SHS_LD2412_MIN_STATIC_GATE, SHS_LD2412_GATES - 1);
+
+    uint8_t basic[SHS_LD2412_BP_LEN];
+    bool basic_dirty = false;
+    if (what & SHS_RADAR_CFG_PARAMS) {
+        shs_ld2412_build_basic(basic, mv_gate, st_gate, cfg->no_one_sec);
+        basic_dirty = shs_ld2412_differs(SHS_LD2412_SH_BASIC, basic, sh->basic, sizeof(basic));
+    }
+
+    uint8_t mv_thr[SHS_LD2412_GATES], st_thr[SHS_LD2412_GATES];
+    bool mv_dirty = false, st_dirty = false;
+    if (what & (SHS_RADAR_CFG_SENS | SHS_RADAR_CFG_GATE_THR | SHS_RADAR_CFG_PARAMS)) {
+        shs_ld2412_build_thresholds(mv_thr, shs_clamp_u8(cfg->moving_sens, 0, 100), cfg->mv_gate_thr, mv_gate);
+        shs_ld2412_build_thresholds(st_thr, shs_clamp_u8(cfg->static_sens, 0, 100), cfg->st_gate_thr, st_gate);
+        mv_dirty = shs_ld2412_differs(SHS_LD2412_SH_MV_THR, mv_thr, sh->mv_thr, sizeof(mv_thr));
+        st_dirty = shs_ld2412_differs(SHS_LD2412_SH_ST_THR, st_thr, sh->st_thr, sizeof(st_thr));
+    }
+
+    if (!basic_dirty && !mv_dirty && !st_dirty) {
+        ESP_LOGD(SHS_TAG, "Config unchanged, no session");
+        return ESP_OK;
+    }
+
+    esp_err_t err = shs_ld24xx_begin_config();
+    if (err == ESP_OK && basic_dirty) {
+        err = shs_ld2412_write(SHS_LD2412_CMD_SET_BASIC, basic, sh->basic, sizeof(basic), SHS_LD2412_SH_BASIC);
+        if (err == ESP_OK) {
+            ESP_LOGI(SHS_TAG, "Applied params: max_gate=%u (move=%u, static=%u), no_one=%us",
+                     (unsigned)basic[SHS_LD2412_BP_MAX_GATE], (unsigned)mv_gate, (unsigned)st_gate,
+                     (unsigned)cfg->no_one_sec);
+        }
+    }
+    if (err == ESP_OK && mv_dirty) {
+        err = shs_ld2412_write(SHS_LD2412_CMD_SET_MV_THR, mv_thr, sh->mv_thr, sizeof(mv_thr), SHS_LD2412_SH_MV_THR);
+    }
+    if (err == ESP_OK && st_dirty) {
+        err = shs_ld2412_write(SHS_LD2412_CMD_SET_ST_THR, st_thr, sh->st_thr, sizeof(st_thr), SHS_LD2412_SH_ST_THR);
+    }
+    if (err == ESP_OK && (mv_dirty || st_dirty)) {
+        ESP_LOGI(SHS_TAG, "Applied thresholds: move=%u (gates 0..%u), static=%u (gates 0..%u)",
+                 (unsigned)cfg->moving_sens, (unsigned)mv_gate, (unsigned)cfg->static_sens, (unsigned)st_gate);
+    }
+
+    /* end is sent even on failure so the module leaves config mode */
+    esp_err_t end = shs_ld24xx_end_config();
+    if (err == ESP_OK) err = end;
+    if (err != ESP_OK) ESP_LOGW(SHS_TAG, "Config not fully applied (%s)", esp_err_to_name(err));
+    return err;
+}
+
+/* Re-read the module into the shadow so the next apply diffs against what it
+ * really holds; drift = it had fallen back to basic frames */
+static esp_err_t shs_ld2412_verify(bool *drift)
+{
+    esp_err_t err = shs_ld24xx_begin_config();
+    if (err == ESP_OK) err = shs_ld2412_shadow_read();
+    esp_err_t end = shs_ld24xx_end_config();
+    if (err == ESP_OK) err = end;
+    if (err != ESP_OK) return err;
+
+    /* a reset module also streams basic frames again */
+    bool d = false;
+    if (shs_ld24xx_eng_seen != SHS_LD2412_ENGINEERING_MODE) {
+        shs_ld24xx_apply_engineering_mode(SHS_LD2412_ENGINEERING_MODE);
+        d = true;
+    }
+    *drift = d;
+    return ESP_OK;
+}
+
+/* Link watchdog steps; a restart forgets the shadow */
+static esp_err_t shs_ld2412_recover(uint8_t step)
+{
+    if (step == SHS_RADAR_RECOVER_RESTART) shs_ld2412_shadow_known = 0;
+    return shs_ld24xx_recover(step, SHS_LD2412_ENGINEERING_MODE);
+}
+
+static const uint32_t shs_ld2412_bauds[] = SHS_LD2412_BAUD_CANDIDATES;
+
+const shs_radar_driver_t shs_radar_driver = {
+    .name            = "LD2412",
+    .max_gate        = SHS_LD2412_GATES - 1,
+    .min_static_gate = SHS_LD2412_MIN_STATIC_GATE,
+    .frame_end_chr   = SHS_LD24XX_TAIL_RX3,
+    .per_gate_thr    = true,
+    .fine_res        = false,
+    .has_distance    = true,
+    .default_baud    = SHS_LD2412_BAUD_DEFAULT,
+    .bauds           = shs_ld2412_bauds,
+    .n_bauds         = sizeof(shs_ld2412_bauds) / sizeof(shs_ld2412_bauds[0]),
+    .upgrade_baud    = SHS_LD2412_BAUD_UPGRADE ? SHS_LD2412_BAUD_TARGET : 0,
+    .probe_ms        = SHS_RADAR_BAUD_PROBE_MS,
+    .probe_frames    = SHS_RADAR_BAUD_PROBE_FRAMES,
+    .set_baud        = shs_ld24xx_set_module_baud,
+    .init            = shs_ld2412_init,
+    .feed            = shs_ld2412_feed,
+    .apply_config    = shs_ld2412_apply_config,
+    .recover         = shs_ld2412_recover,
+    .verify          = shs_ld2412_verify,
+};
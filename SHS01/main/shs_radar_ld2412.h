@@ -0,0 +1,53 @@
+/*
+ * SPDX-FileCopyrightText: 2021-2025
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+#ifndef SHS_RADAR_LD2412_H
+#define SHS_RADAR_LD2412_H
+
+/* ---------------- LD2412 constants ----------------
+ * Framing, session and shared commands: shs_radar_ld24xx.h. The report has
+ * no detection distance and the config set is per-gate. */
+
+/* Report frame layout (shared offsets: shs_radar_ld24xx.h) */
+#define SHS_LD2412_BASIC_PAYLOAD_LEN    11  /* type..check byte */
+
+/* Engineering-mode extension (follows SHS_LD24XX_OFF_ST_ENERGY) */
+#define SHS_LD2412_OFF_ENG_MV_MAX_GATE  15  /* N: moving gates 0..N follow */
+#define SHS_LD2412_OFF_ENG_ST_MAX_GATE  16  /* M: static gates 0..M follow */
+#define SHS_LD2412_OFF_ENG_GATES        17  /* N+1 moving, then M+1 static energies */
+#define SHS_LD2412_ENG_TRAILER_LEN      3   /* light, 0x55, 0x00 */
+
+#define SHS_LD2412_GATES                14  /* gates 0..13 */
+#define SHS_LD2412_MIN_STATIC_GATE      1
+#define SHS_LD2412_THR_OFF              100 /* threshold no energy can exceed: gate disabled */
+
+/* Commands */
+#define SHS_LD2412_CMD_SET_BASIC        0x0002  /* min gate, max gate, no-one LE16, OUT polarity */
+#define SHS_LD2412_CMD_SET_MV_THR       0x0003  /* 14 moving thresholds */
+#define SHS_LD2412_CMD_SET_ST_THR       0x0004  /* 14 static thresholds */
+#define SHS_LD2412_CMD_READ_BASIC       0x0012  /* ACK data: as SET_BASIC */
+#define SHS_LD2412_CMD_READ_MV_THR      0x0013  /* ACK data: 14 moving thresholds */
+#define SHS_LD2412_CMD_READ_ST_THR      0x0014  /* ACK data: 14 static thresholds */
+
+/* Basic-parameter record (SET_BASIC args, READ_BASIC ACK data) */
+#define SHS_LD2412_BP_MIN_GATE          0
+#define SHS_LD2412_BP_MAX_GATE          1
+#define SHS_LD2412_BP_NO_ONE            2   /* LE16 s */
+#define SHS_LD2412_BP_OUT_POL           4
+#define SHS_LD2412_BP_LEN               5
+
+#define SHS_LD2412_MIN_GATE             1   /* nearest gate the module accepts */
+#define SHS_LD2412_OUT_ACTIVE_HIGH      0x00
+
+/* Stream per-gate energies (engineering frames) instead of basic reports */
+#define SHS_LD2412_ENGINEERING_MODE     1
+
+/* Baud: candidates to probe, and the rate to switch the module to */
+#define SHS_LD2412_BAUD_DEFAULT         115200
+#define SHS_LD2412_BAUD_CANDIDATES      { 115200, 256000, 57600, 230400, 460800, 38400, 19200, 9600 }
+#define SHS_LD2412_BAUD_UPGRADE         1       /* switch the module to SHS_LD2412_BAUD_TARGET */
+#define SHS_LD2412_BAUD_TARGET          256000
+
+#endif /* SHS_RADAR_LD2412_H */
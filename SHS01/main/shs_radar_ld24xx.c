@@ -0,0 +1,368 @@
+/*
+ * SPDX-FileCopyrightText: 2021-2025
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+#include <stdbool.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "esp_log.h"
+#include "nvs.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include "shs_radar.h"
+#include "shs_radar_ld24xx.h"
+
+_Static_assert(SHS_LD24XX_MAX_PAYLOAD_LEN <= SHS_RADAR_MAX_PAYLOAD_LEN, "SHS_RADAR_MAX_PAYLOAD_LEN too small for LD24xx");
+
+/* Logs carry the linked model's name */
+#define SHS_TAG (shs_radar_driver.name)
+
+volatile bool shs_ld24xx_eng_seen = false;
+
+/* ---------------- Frame writers ---------------- */
+/* Build hdr(4) + len(2 LE) + payload + tail(4) into buf; returns total length */
+static size_t shs_ld24xx_build_frame(uint8_t *p, const uint8_t *payload, uint16_t payload_len)
+{
+    p[0]=SHS_LD24XX_HDR_TX0; p[1]=SHS_LD24XX_HDR_TX1; p[2]=SHS_LD24XX_HDR_TX2; p[3]=SHS_LD24XX_HDR_TX3;
+    p[4]=(uint8_t)(payload_len & 0xFF);
+    p[5]=(uint8_t)((payload_len >> 8) & 0xFF);
+    memcpy(&p[6], payload, payload_len);
+    p[6 + payload_len + 0]=SHS_LD24XX_TAIL_TX0;
+    p[6 + payload_len + 1]=SHS_LD24XX_TAIL_TX1;
+    p[6 + payload_len + 2]=SHS_LD24XX_TAIL_TX2;
+    p[6 + payload_len + 3]=SHS_LD24XX_TAIL_TX3;
+    return 4 + 2 + (size_t)payload_len + 4;
+}
+
+/* Fire-and-forget write, for a module that stopped answering */
+static void shs_ld24xx_write_cmd(uint16_t cmd, const uint8_t *args, uint16_t args_len)
+{
+    uint8_t payload[2 + SHS_LD24XX_MAX_CMD_ARGS];
+    if (args_len > SHS_LD24XX_MAX_CMD_ARGS) return;
+    payload[0] = (uint8_t)(cmd & 0xFF);
+    payload[1] = (uint8_t)((cmd >> 8) & 0xFF);
+    if (args_len) memcpy(&payload[2], args, args_len);
+
+    uint8_t frame[4 + 2 + sizeof(payload) + 4];
+    shs_radar_write(frame, shs_ld24xx_build_frame(frame, payload, 2 + args_len));
+}
+
+esp_err_t shs_ld24xx_cmd(uint16_t cmd, const uint8_t *args, uint16_t args_len, shs_radar_ack_t *ack)
+{
+    if (args_len > SHS_LD24XX_MAX_CMD_ARGS) return ESP_ERR_INVALID_SIZE;
+
+    uint8_t payload[2 + SHS_LD24XX_MAX_CMD_ARGS];
+    payload[0] = (uint8_t)(cmd & 0xFF);
+    payload[1] = (uint8_t)((cmd >> 8) & 0xFF);
+    if (args_len) memcpy(&payload[2], args, args_len);
+
+    uint8_t frame[4 + 2 + sizeof(payload) + 4];
+    size_t n = shs_ld24xx_build_frame(frame, payload, 2 + args_len);
+    return shs_radar_cmd_xfer(cmd, frame, n, ack);
+}
+
+esp_err_t shs_ld24xx_begin_config(void)
+{
+    const uint8_t args[] = { 0x01, 0x00 };
+    return shs_ld24xx_cmd(SHS_LD24XX_CMD_BEGIN_CONFIG, args, sizeof(args), NULL);
+}
+
+esp_err_t shs_ld24xx_end_config(void)
+{
+    return shs_ld24xx_cmd(SHS_LD24XX_CMD_END_CONFIG, NULL, 0, NULL);
+}
+
+esp_err_t shs_ld24xx_session_cmd(uint16_t cmd, const uint8_t *args, uint16_t args_len)
+{
+    esp_err_t err = shs_ld24xx_begin_config();
+    if (err == ESP_OK) err = shs_ld24xx_cmd(cmd, args, args_len, NULL);
+    esp_err_t end = shs_ld24xx_end_config();
+    return (err == ESP_OK) ? end : err;
+}
+
+/* The restart also leaves config mode */
+esp_err_t shs_ld24xx_restart_in_session(void)
+{
+    esp_err_t err = shs_ld24xx_cmd(SHS_LD24XX_CMD_RESTART_MODULE, NULL, 0, NULL);
+    if (err != ESP_OK) {
+        ESP_LOGW(SHS_TAG, "Module restart failed (%s)", esp_err_to_name(err));
+        shs_ld24xx_end_config();
+        return err;
+    }
+    ESP_LOGI(SHS_TAG, "Module restart command sent to %s.", shs_radar_driver.name);
+    vTaskDelay(pdMS_TO_TICKS(SHS_RADAR_RESTART_MS)); /* wait for module to be ready */
+    return ESP_OK;
+}
+
+void shs_ld24xx_apply_engineering_mode(bool enable)
+{
+    const uint16_t cmd = enable ? SHS_LD24XX_CMD_ENG_MODE_ON : SHS_LD24XX_CMD_ENG_MODE_OFF;
+
+    esp_err_t err = shs_ld24xx_session_cmd(cmd, NULL, 0);
+    if (err != ESP_OK) {
+        ESP_LOGW(SHS_TAG, "Engineering mode change failed (%s)", esp_err_to_name(err));
+        return;
+    }
+    ESP_LOGI(SHS_TAG, "Engineering mode %s", enable ? "enabled" : "disabled");
+}
+
+/* ---------------- Identity / BLE ---------------- */
+bool shs_ld24xx_identify(uint8_t *mac)
+{
+    shs_radar_ack_t ack;
+    if (shs_ld24xx_cmd(SHS_LD24XX_CMD_READ_FIRMWARE, NULL, 0, &ack) == ESP_OK && ack.len >= SHS_LD24XX_FW_ACK_LEN) {
+        uint16_t major = (uint16_t)ack.data[2] | ((uint16_t)ack.data[3] << 8);
+        uint32_t minor = (uint32_t)ack.data[4] | ((uint32_t)ack.data[5] << 8) |
+                         ((uint32_t)ack.data[6] << 16) | ((uint32_t)ack.data[7] << 24);
+        ESP_LOGI(SHS_TAG, "Firmware V%u.%02u.%08x", (unsigned)(major >> 8), (unsigned)(major & 0xFF), (unsigned)minor);
+    }
+
+    const uint8_t mac_args[] = { 0x01, 0x00 };
+    if (shs_ld24xx_cmd(SHS_LD24XX_CMD_GET_MAC, mac_args, sizeof(mac_args), &ack) == ESP_OK &&
+        ack.len >= SHS_LD24XX_MAC_ACK_LEN) {
+        memcpy(mac, ack.data, SHS_LD24XX_MAC_ACK_LEN);
+        return true;
+    }
+    return false;
+}
+
+/* MAC of the module BLE was last disabled on (NVS); all-zero if none */
+static bool shs_ld24xx_ble_off_matches(const uint8_t *mac)
+{
+    uint8_t stored[SHS_LD24XX_MAC_ACK_LEN] = {0};
+    size_t len = sizeof(stored);
+    nvs_handle_t h;
+    if (nvs_open(SHS_LD24XX_NVS_NAMESPACE, NVS_READONLY, &h) != ESP_OK) return false;
+    esp_err_t err = nvs_get_blob(h, SHS_LD24XX_NVS_KEY_BLE_OFF_MAC, stored, &len);
+    nvs_close(h);
+    return err == ESP_OK && len == sizeof(stored) && memcmp(stored, mac, sizeof(stored)) == 0;
+}
+
+static void shs_ld24xx_ble_off_remember(const uint8_t *mac)
+{
+    nvs_handle_t h;
+    if (nvs_open(SHS_LD24XX_NVS_NAMESPACE, NVS_READWRITE, &h) != ESP_OK) return;
+    nvs_set_blob(h, SHS_LD24XX_NVS_KEY_BLE_OFF_MAC, mac, SHS_LD24XX_MAC_ACK_LEN);
+    nvs_commit(h);
+    nvs_close(h);
+}
+
+/* Returns true once the module has been restarted with BLE off */
+static bool shs_ld24xx_disable_ble(void)
+{
+    const uint8_t ble_off[] = { 0x00, 0x00 };
+    esp_err_t err = shs_ld24xx_session_cmd(SHS_LD24XX_CMD_BLE_ENABLE, ble_off, sizeof(ble_off));
+    if (err != ESP_OK) {
+        ESP_LOGW(SHS_TAG, "Bluetooth LE disable failed (%s)", esp_err_to_name(err));
+        return false;
+    }
+    ESP_LOGI(SHS_TAG, "Bluetooth LE disabled on %s.", shs_radar_driver.name);
+
+    /* the BLE change takes effect after a restart */
+    vTaskDelay(pdMS_TO_TICKS(200));
+    err = shs_ld24xx_begin_config();
+    if (err == ESP_OK) return shs_ld24xx_restart_in_session() == ESP_OK;
+    ESP_LOGW(SHS_TAG, "Module restart failed (%s)", esp_err_to_name(err));
+    shs_ld24xx_end_config();
+    return false;
+}
+
+/* BLE off persists in the module; restart only for a module not seen before */
+bool shs_ld24xx_ble_off_once(const uint8_t *mac, bool have_mac)
+{
+    if (have_mac && shs_ld24xx_ble_off_matches(mac)) {
+        ESP_LOGI(SHS_TAG, "Bluetooth LE already off on this module, no restart");
+        return false;
+    }
+    bool restarted = shs_ld24xx_disable_ble();
+    if (restarted && have_mac) shs_ld24xx_ble_off_remember(mac);
+    return restarted;
+}
+
+/* ---------------- Baud / recovery ---------------- */
+/* Set-baud index; 0 if unsupported */
+static uint16_t shs_ld24xx_baud_index(uint32_t baud)
+{
+    static const uint32_t rates[] = { 9600, 19200, 38400, 57600, 115200, 230400, 256000, 460800 };
+    for (uint16_t i = 0; i < sizeof(rates) / sizeof(rates[0]); ++i) {
+        if (rates[i] == baud) return (uint16_t)(i + 1);
+    }
+    return 0;
+}
+
+/* Takes effect after the module restarts. Runs during baud negotiation, where
+ * ACKs are parsed inline: each step waits for its ACK at the old rate. */
+esp_err_t shs_ld24xx_set_module_baud(uint32_t baud)
+{
+    uint16_t idx = shs_ld24xx_baud_index(baud);
+    if (idx == 0) return ESP_ERR_NOT_SUPPORTED;
+
+    const uint8_t args[] = { (uint8_t)(idx & 0xFF), (uint8_t)((idx >> 8) & 0xFF) };
+    esp_err_t err = shs_ld24xx_begin_config();
+    if (err == ESP_OK) err = shs_ld24xx_cmd(SHS_LD24XX_CMD_SET_BAUD, args, sizeof(args), NULL);
+    if (err != ESP_OK) {
+        ESP_LOGW(SHS_TAG, "Set-baud %u failed (%s)", (unsigned)baud, esp_err_to_name(err));
+        shs_ld24xx_end_config();
+        return err;
+    }
+    ESP_LOGI(SHS_TAG, "Set-baud %u accepted, restarting %s", (unsigned)baud, shs_radar_driver.name);
+    return shs_ld24xx_restart_in_session();
+}
+
+/* Link watchdog steps; a module that ignores begin-config still gets the raw restart */
+esp_err_t shs_ld24xx_recover(uint8_t step, bool engineering)
+{
+    if (step == SHS_RADAR_RECOVER_END_CONFIG) {
+        ESP_LOGW(SHS_TAG, "Recovery: end config");
+        return shs_ld24xx_end_config();
+    }
+    if (step != SHS_RADAR_RECOVER_RESTART) return ESP_ERR_NOT_SUPPORTED;
+
+    ESP_LOGW(SHS_TAG, "Recovery: restart module");
+    esp_err_t err = shs_ld24xx_begin_config();
+    if (err == ESP_OK) err = shs_ld24xx_restart_in_session();
+    if (err != ESP_OK) {
+        const uint8_t begin_args[] = { 0x01, 0x00 };
+        shs_ld24xx_write_cmd(SHS_LD24XX_CMD_BEGIN_CONFIG, begin_args, sizeof(begin_args));
+        vTaskDelay(pdMS_TO_TICKS(100));
+        shs_ld24xx_write_cmd(SHS_LD24XX_CMD_RESTART_MODULE, NULL, 0);
+        vTaskDelay(pdMS_TO_TICKS(SHS_RADAR_RESTART_MS));
+    }
+    if (engineering) shs_ld24xx_apply_engineering_mode(true);
+    return err;
+}
+
+/* ---------------- Frame parser ---------------- */
+/* Payload-level checks for a complete report at the ring read position */
+static bool shs_ld24xx_frame_valid(const shs_ld24xx_model_t *model, uint16_t le_len)
+{
+    size_t total = 4 + 2 + (size_t)le_len + 4;
+    uint8_t type = shs_rx_at(SHS_LD24XX_OFF_TYPE);
+
+    if (type == SHS_LD24XX_TYPE_BASIC) {
+        if (le_len != model->basic_payload_len) return false;
+    } else if (type == SHS_LD24XX_TYPE_ENGINEERING) {
+        if (le_len <= model->basic_payload_len) return false;
+    } else {
+        return false;
+    }
+
+    return shs_rx_at(SHS_LD24XX_OFF_HEAD) == SHS_LD24XX_RPT_HEAD &&
+           shs_rx_at(total - 6)           == SHS_LD24XX_RPT_TAIL &&
+           shs_rx_at(total - 5)           == SHS_LD24XX_RPT_CHECK &&
+           shs_rx_at(total - 4)           == SHS_LD24XX_TAIL_RX0 &&
+           shs_rx_at(total - 3)           == SHS_LD24XX_TAIL_RX1 &&
+           shs_rx_at(total - 2)           == SHS_LD24XX_TAIL_RX2 &&
+           shs_rx_at(total - 1)           == SHS_LD24XX_TAIL_RX3;
+}
+
+static inline bool shs_ld24xx_is_report_hdr(size_t h)
+{
+    return shs_rx_at(h)     == SHS_LD24XX_HDR_RX0 &&
+           shs_rx_at(h + 1) == SHS_LD24XX_HDR_RX1 &&
+           shs_rx_at(h + 2) == SHS_LD24XX_HDR_RX2 &&
+           shs_rx_at(h + 3) == SHS_LD24XX_HDR_RX3;
+}
+
+static inline bool shs_ld24xx_is_ack_hdr(size_t h)
+{
+    return shs_rx_at(h)     == SHS_LD24XX_HDR_TX0 &&
+           shs_rx_at(h + 1) == SHS_LD24XX_HDR_TX1 &&
+           shs_rx_at(h + 2) == SHS_LD24XX_HDR_TX2 &&
+           shs_rx_at(h + 3) == SHS_LD24XX_HDR_TX3;
+}
+
+/* Command ACK at the ring read position: returns bytes to consume, 0 = incomplete, -1 = invalid */
+static int shs_ld24xx_take_ack(size_t used)
+{
+    uint16_t le_len = shs_rx_le16(SHS_LD24XX_OFF_LEN);
+    if (le_len < SHS_LD24XX_ACK_MIN_PAYLOAD_LEN || le_len > SHS_LD24XX_MAX_PAYLOAD_LEN) return -1;
+
+    size_t total = 4 + 2 + (size_t)le_len + 4;
+    if (total > used) return 0;
+
+    uint16_t cmd = shs_rx_le16(SHS_LD24XX_OFF_ACK_CMD);
+    if (!(cmd & SHS_LD24XX_ACK_BIT) ||
+        shs_rx_at(total - 4) != SHS_LD24XX_TAIL_TX0 ||
+        shs_rx_at(total - 3) != SHS_LD24XX_TAIL_TX1 ||
+        shs_rx_at(total - 2) != SHS_LD24XX_TAIL_TX2 ||
+        shs_rx_at(total - 1) != SHS_LD24XX_TAIL_TX3) {
+        return -1;
+    }
+
+    shs_radar_ack_t ack;
+    ack.cmd    = cmd & (uint16_t)~SHS_LD24XX_ACK_BIT;
+    ack.status = shs_rx_le16(SHS_LD24XX_OFF_ACK_STATUS);
+    size_t n   = (size_t)le_len - SHS_LD24XX_ACK_MIN_PAYLOAD_LEN;
+    ack.len    = (uint8_t)(n > SHS_RADAR_ACK_MAX_DATA ? SHS_RADAR_ACK_MAX_DATA : n);
+    for (uint8_t k = 0; k < ack.len; ++k) ack.data[k] = shs_rx_at(SHS_LD24XX_OFF_ACK_DATA + k);
+    shs_radar_ack_post(&ack);
+    return (int)total;
+}
+
+void shs_ld24xx_feed(const shs_ld24xx_model_t *model, shs_radar_report_cb_t on_report)
+{
+    while (shs_rx_used() >= SHS_LD24XX_MIN_FRAME_BYTES) {
+        size_t used = shs_rx_used();
+        size_t h = 0;
+        for (; h + 4 <= used; ++h) {
+            if (shs_ld24xx_is_report_hdr(h) || shs_ld24xx_is_ack_hdr(h)) break;
+        }
+        if (h + 4 > used) {
+            /* no header: keep the last 3 bytes, they may start one */
+            shs_radar_stats.resyncs++;
+            shs_rx_discard(used - 3);
+            return;
+        }
+        if (h > 0) {
+            shs_radar_stats.resyncs++;
+            shs_rx_discard(h);
+            used -= h;
+        }
+        if (used < SHS_LD24XX_OFF_TYPE) return; /* wait for the length field */
+
+        if (shs_ld24xx_is_ack_hdr(0)) {
+            int n = shs_ld24xx_take_ack(used);
+            if (n == 0) return;
+            if (n < 0) {
+                shs_radar_stats.bad_frames++;
+                shs_rx_discard(1);
+            } else {
+                shs_rx_consume((size_t)n);
+            }
+            continue;
+        }
+
+        uint16_t le_len = shs_rx_le16(SHS_LD24XX_OFF_LEN);
+        if (le_len < model->basic_payload_len || le_len > SHS_LD24XX_MAX_PAYLOAD_LEN) {
+            /* implausible length: this header is noise, resync past it */
+            shs_radar_stats.bad_frames++;
+            shs_rx_discard(1);
+            continue;
+        }
+
+        size_t total = 4 + 2 + (size_t)le_len + 4;
+        if (total > used) return; /* wait for the rest */
+
+        if (!shs_ld24xx_frame_valid(model, le_len)) {
+            shs_radar_stats.bad_frames++;
+            shs_rx_discard(1);
+            continue;
+        }
+
+        shs_radar_stats.good_frames++;
+        shs_ld24xx_eng_seen = (shs_rx_at(SHS_LD24XX_OFF_TYPE) == SHS_LD24XX_TYPE_ENGINEERING);
+        if (shs_radar_payload_repeat(SHS_LD24XX_OFF_TYPE, le_len)) {
+            /* nothing changed; timers still advance in the task loop */
+            shs_radar_stats.duplicate_frames++;
+        } else {
+            shs_radar_report_t rpt;
+            model->decode(le_len, &rpt);
+            on_report(&rpt);
+        }
+        shs_rx_consume(total);
+    }
+}
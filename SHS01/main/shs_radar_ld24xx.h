@@ -0,0 +1,123 @@
+/*
+ * SPDX-FileCopyrightText: 2021-2025
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+#ifndef SHS_RADAR_LD24XX_H
+#define SHS_RADAR_LD24XX_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+#include "shs_radar.h"
+
+/* ---------------- Hi-Link LD24xx framing ----------------
+ * LD2410 and LD2412 share the wire format: FD..FA command/ACK frames,
+ * F4..F1 report frames, the command session (begin / end config), ACK
+ * layout, engineering-mode switch, BLE, restart and baud commands. The
+ * model drivers keep only their report layout and config commands. */
+#define SHS_LD24XX_HDR_TX0              0xFD
+#define SHS_LD24XX_HDR_TX1              0xFC
+#define SHS_LD24XX_HDR_TX2              0xFB
+#define SHS_LD24XX_HDR_TX3              0xFA
+#define SHS_LD24XX_TAIL_TX0             0x04
+#define SHS_LD24XX_TAIL_TX1             0x03
+#define SHS_LD24XX_TAIL_TX2             0x02
+#define SHS_LD24XX_TAIL_TX3             0x01
+
+#define SHS_LD24XX_HDR_RX0              0xF4
+#define SHS_LD24XX_HDR_RX1              0xF3
+#define SHS_LD24XX_HDR_RX2              0xF2
+#define SHS_LD24XX_HDR_RX3              0xF1
+#define SHS_LD24XX_TAIL_RX0             0xF8
+#define SHS_LD24XX_TAIL_RX1             0xF7
+#define SHS_LD24XX_TAIL_RX2             0xF6
+#define SHS_LD24XX_TAIL_RX3             0xF5
+
+#define SHS_LD24XX_MIN_FRAME_BYTES      9
+#define SHS_LD24XX_MAX_PAYLOAD_LEN      64  /* anything longer is a false header */
+
+/* Report frame layout shared by both models (byte offsets from the F4 header) */
+#define SHS_LD24XX_OFF_LEN              4   /* LE16 payload length */
+#define SHS_LD24XX_OFF_TYPE             6   /* 0x02 basic, 0x01 engineering */
+#define SHS_LD24XX_OFF_HEAD             7   /* 0xAA */
+#define SHS_LD24XX_OFF_STATE            8   /* bit0 moving, bit1 static */
+#define SHS_LD24XX_OFF_MV_DIST          9   /* LE16 cm */
+#define SHS_LD24XX_OFF_MV_ENERGY        11  /* 0..100 */
+#define SHS_LD24XX_OFF_ST_DIST          12  /* LE16 cm */
+#define SHS_LD24XX_OFF_ST_ENERGY        14  /* 0..100 */
+
+/* In-payload markers */
+#define SHS_LD24XX_RPT_HEAD             0xAA
+#define SHS_LD24XX_RPT_TAIL             0x55
+#define SHS_LD24XX_RPT_CHECK            0x00
+
+#define SHS_LD24XX_TYPE_ENGINEERING     0x01
+#define SHS_LD24XX_TYPE_BASIC           0x02
+
+/* Command ACK layout (byte offsets from the FD header) */
+#define SHS_LD24XX_OFF_ACK_CMD          6   /* LE16 command | 0x0100 */
+#define SHS_LD24XX_OFF_ACK_STATUS       8   /* LE16, 0 = success */
+#define SHS_LD24XX_OFF_ACK_DATA         10  /* command-specific return values */
+#define SHS_LD24XX_ACK_MIN_PAYLOAD_LEN  4   /* cmd + status */
+#define SHS_LD24XX_ACK_BIT              0x0100
+#define SHS_LD24XX_MAX_CMD_ARGS         32
+
+/* Commands both models understand */
+#define SHS_LD24XX_CMD_BEGIN_CONFIG     0x00FF
+#define SHS_LD24XX_CMD_END_CONFIG       0x00FE
+#define SHS_LD24XX_CMD_ENG_MODE_ON      0x0062
+#define SHS_LD24XX_CMD_ENG_MODE_OFF     0x0063
+#define SHS_LD24XX_CMD_READ_FIRMWARE    0x00A0
+#define SHS_LD24XX_CMD_SET_BAUD         0x00A1
+#define SHS_LD24XX_CMD_RESTART_MODULE   0x00A3
+#define SHS_LD24XX_CMD_BLE_ENABLE       0x00A4
+#define SHS_LD24XX_CMD_GET_MAC          0x00A5
+
+/* ACK data layouts (offsets after the status word) */
+#define SHS_LD24XX_FW_ACK_LEN           8   /* type LE16, major LE16, minor LE32 */
+#define SHS_LD24XX_MAC_ACK_LEN          6
+
+/* Module whose BLE this firmware already turned off (NVS, survives reboots);
+ * the namespace predates LD2412 support and is kept for existing installs */
+#define SHS_LD24XX_NVS_NAMESPACE        "ld2410"
+#define SHS_LD24XX_NVS_KEY_BLE_OFF_MAC  "ble_off_mac"  /* blob[6] */
+
+/* Model hooks for the shared parser */
+typedef struct {
+    uint16_t basic_payload_len;     /* basic report; engineering reports are longer */
+    void (*decode)(uint16_t payload_len, shs_radar_report_t *out);
+} shs_ld24xx_model_t;
+
+/* Type of the last valid report: engineering frames are streaming */
+extern volatile bool shs_ld24xx_eng_seen;
+
+static inline uint16_t shs_clamp_u16(uint16_t v, uint16_t lo, uint16_t hi) { return v < lo ? lo : (v > hi ? hi : v); }
+static inline uint8_t  shs_clamp_u8 (uint8_t  v, uint8_t  lo, uint8_t  hi) { return v < lo ? lo : (v > hi ? hi : v); }
+
+/* ---------------- Commands ---------------- */
+/* Send one command and wait for its ACK (see shs_radar_cmd_xfer) */
+esp_err_t shs_ld24xx_cmd(uint16_t cmd, const uint8_t *args, uint16_t args_len, shs_radar_ack_t *ack);
+esp_err_t shs_ld24xx_begin_config(void);
+esp_err_t shs_ld24xx_end_config(void);
+/* begin + one command + end; end is sent even on failure */
+esp_err_t shs_ld24xx_session_cmd(uint16_t cmd, const uint8_t *args, uint16_t args_len);
+/* Restart from inside an open config session and wait for the module */
+esp_err_t shs_ld24xx_restart_in_session(void);
+void shs_ld24xx_apply_engineering_mode(bool enable);
+
+/* ---------------- Driver op building blocks ---------------- */
+/* Inside an open session: log firmware, fetch the MAC; true if mac was filled */
+bool shs_ld24xx_identify(uint8_t *mac);
+/* Turn BLE off unless this module (by MAC) already had it turned off; true if restarted */
+bool shs_ld24xx_ble_off_once(const uint8_t *mac, bool have_mac);
+/* set_baud op: ACKed set-baud + restart, returns once the module is back */
+esp_err_t shs_ld24xx_set_module_baud(uint32_t baud);
+/* recover op; the caller forgets its shadow before RESTART */
+esp_err_t shs_ld24xx_recover(uint8_t step, bool engineering);
+
+/* feed op: parse reports (via model) and command ACKs from the RX ring */
+void shs_ld24xx_feed(const shs_ld24xx_model_t *model, shs_radar_report_cb_t on_report);
+
+#endif /* SHS_RADAR_LD24XX_H */
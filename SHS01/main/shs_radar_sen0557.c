@@ -0,0 +1,216 @@
+/*
+ * SPDX-FileCopyrightText: 2021-2025
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+#include <stdbool.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdarg.h>
+
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include "shs_radar.h"
+#include "shs_radar_sen0557.h"
+
+_Static_assert(SHS_SEN0557_GATES <= SHS_RADAR_MAX_GATES, "SHS_RADAR_MAX_GATES too small for SEN0557");
+_Static_assert(SHS_SEN0557_MAX_LINE <= SHS_RADAR_MAX_PAYLOAD_LEN, "SHS_RADAR_MAX_PAYLOAD_LEN too small for SEN0557");
+
+static const char *SHS_TAG = "SEN0557";
+
+/* ---------------- Command writer ---------------- */
+static void shs_sen0557_cmd(const char *fmt, ...)
+{
+    char line[48];
+    va_list ap;
+    va_start(ap, fmt);
+    int n = vsnprintf(line, sizeof(line) - 2, fmt, ap);
+    va_end(ap);
+    if (n < 0) return;
+    if (n > (int)sizeof(line) - 3) n = sizeof(line) - 3;
+
+    line[n++] = '\r';
+    line[n++] = '\n';
+    shs_radar_write((const uint8_t *)line, (size_t)n);
+    vTaskDelay(pdMS_TO_TICKS(SHS_SEN0557_CMD_GAP_MS));
+}
+
+static inline uint16_t shs_clamp_u16(uint16_t v, uint16_t lo, uint16_t hi) { return v < lo ? lo : (v > hi ? hi : v); }
+
+/* ---------------- Line parser ----------------
+ * Lines are matched in the RX ring without copying; only "$JYBSS" reports
+ * are turned into reports, command echoes/answers are skipped. */
+static bool shs_sen0557_line_valid(size_t end)
+{
+    static const char tag[] = SHS_SEN0557_REPORT_TAG;
+
+    if (end < SHS_SEN0557_REPORT_TAG_LEN + 2) return false;
+    for (size_t k = 0; k < SHS_SEN0557_REPORT_TAG_LEN; ++k) {
+        if (shs_rx_at(k) != (uint8_t)tag[k]) return false;
+    }
+
+    uint8_t state = shs_rx_at(SHS_SEN0557_REPORT_TAG_LEN);
+    if (state != '0' && state != '1') return false;
+
+    /* '*' closes the field list, optionally followed by '\r' */
+    size_t last = end - 1;
+    if (shs_rx_at(last) == '\r') last--;
+    return shs_rx_at(last) == SHS_SEN0557_REPORT_STOP;
+}
+
+static void shs_sen0557_feed(shs_radar_report_cb_t on_report)
+{
+    while (shs_rx_used() > 0) {
+        size_t used = shs_rx_used();
+
+        size_t h = 0;
+        while (h < used && shs_rx_at(h) != SHS_SEN0557_LINE_START) ++h;
+        if (h > 0) {
+            /* prompts and command answers, not an error */
+            shs_rx_discard(h);
+            used -= h;
+            if (used == 0) return;
+        }
+
+        size_t limit = used < SHS_SEN0557_MAX_LINE ? used : SHS_SEN0557_MAX_LINE;
+        size_t e = 1;
+        while (e < limit && shs_rx_at(e) != SHS_SEN0557_LINE_END) ++e;
+        if (e >= limit) {
+            if (used < SHS_SEN0557_MAX_LINE) return; /* wait for the rest of the line */
+            /* no terminator within a line length: resync past this '$' */
+            shs_radar_stats.bad_frames++;
+            shs_radar_stats.resyncs++;
+            shs_rx_discard(1);
+            continue;
+        }
+
+        size_t len = e + 1;
+        if (!shs_sen0557_line_valid(e)) {
+            shs_radar_stats.bad_frames++;
+            shs_rx_discard(len);
+            continue;
+        }
+
+        shs_radar_stats.good_frames++;
+        if (shs_radar_payload_repeat(0, (uint16_t)len)) {
+            shs_radar_stats.duplicate_frames++;
+        } else {
+            /* presence only: no moving/static split, distance or energy */
+            shs_radar_report_t rpt;
+            memset(&rpt, 0, sizeof(rpt));
+            if (shs_rx_at(SHS_SEN0557_REPORT_TAG_LEN) == '1') rpt.target_state = SHS_RADAR_STATE_STATIC;
+            on_report(&rpt);
+        }
+        shs_rx_consume(len);
+    }
+}
+
+/* ---------------- Driver ops ----------------
+ * The module has no read-back, so the last values sent are shadowed here:
+ * unchanged settings are not re-sent and saveConfig (a module flash write)
+ * only follows a real change. Every boot re-applies the full config, so the
+ * first apply after init is sent without saving. */
+static struct {
+    bool     known;
+    unsigned sens;
+    unsigned cm;
+    unsigned clear_s;
+} shs_sen0557_sent;
+
+static void shs_sen0557_init(void)
+{
+    shs_sen0557_sent.known = false;     /* module may have reloaded its flash */
+    shs_sen0557_cmd(SHS_SEN0557_CMD_STOP);
+    shs_sen0557_cmd(SHS_SEN0557_CMD_UART_OUTPUT " 1 1");
+    shs_sen0557_cmd(SHS_SEN0557_CMD_START);
+    ESP_LOGI(SHS_TAG, "Presence line output enabled");
+}
+
+/* Map the LD2410-style config cluster onto the leapMMW command set */
+static esp_err_t shs_sen0557_apply_config(const shs_radar_cfg_t *cfg, uint32_t what)
+{
+    if (!(what & (SHS_RADAR_CFG_SENS | SHS_RADAR_CFG_PARAMS))) return ESP_OK;
+
+    bool known = shs_sen0557_sent.known;
+    bool sens_dirty = false, params_dirty = false;
+    unsigned sens = shs_sen0557_sent.sens;
+    unsigned cm = shs_sen0557_sent.cm;
+    unsigned clear_s = shs_sen0557_sent.clear_s;
+
+    if (what & SHS_RADAR_CFG_SENS) {
+        /* single sensitivity: the moving slider drives it. The slider is a
+         * threshold (higher = less sensitive), the module's 0..9 is not. */
+        unsigned thr = cfg->moving_sens > 100 ? 100 : cfg->moving_sens;
+        sens = SHS_SEN0557_SENS_MAX - (thr * SHS_SEN0557_SENS_MAX + 50) / 100;
+        sens_dirty = !known || sens != shs_sen0557_sent.sens;
+    }
+
+    if (what & SHS_RADAR_CFG_PARAMS) {
+        /* single range: the farther of the two gates */
+        uint16_t gate = cfg->moving_max_gate > cfg->static_max_gate ? cfg->moving_max_gate : cfg->static_max_gate;
+        gate = shs_clamp_u16(gate, SHS_SEN0557_MIN_STATIC_GATE, SHS_SEN0557_GATES - 1);
+        cm = (unsigned)gate * SHS_SEN0557_CM_PER_GATE;
+        clear_s = shs_clamp_u16(cfg->no_one_sec, 0, SHS_SEN0557_LATENCY_MAX_S);
+        params_dirty = !known || cm != shs_sen0557_sent.cm || clear_s != shs_sen0557_sent.clear_s;
+    }
+
+    if (!sens_dirty && !params_dirty) return ESP_OK;
+
+    shs_sen0557_cmd(SHS_SEN0557_CMD_STOP);
+
+    if (sens_dirty) {
+        shs_sen0557_cmd(SHS_SEN0557_CMD_SENSITIVITY " %u", sens);
+        ESP_LOGI(SHS_TAG, "Applied sensitivity: %u/%u", sens, (unsigned)SHS_SEN0557_SENS_MAX);
+    }
+
+    if (params_dirty) {
+        shs_sen0557_cmd(SHS_SEN0557_CMD_RANGE " 0 %u.%02u", cm / 100, cm % 100);
+        shs_sen0557_cmd(SHS_SEN0557_CMD_LATENCY " 0 %u", clear_s);
+        ESP_LOGI(SHS_TAG, "Applied params: range=%ucm, clear=%us", cm, clear_s);
+    }
+
+    if (known) shs_sen0557_cmd(SHS_SEN0557_CMD_SAVE);
+    shs_sen0557_cmd(SHS_SEN0557_CMD_START);
+
+    shs_sen0557_sent.sens = sens;
+    shs_sen0557_sent.cm = cm;
+    shs_sen0557_sent.clear_s = clear_s;
+    /* a partial first apply leaves the other half unknown */
+    shs_sen0557_sent.known = known || (what & (SHS_RADAR_CFG_SENS | SHS_RADAR_CFG_PARAMS)) == (SHS_RADAR_CFG_SENS | SHS_RADAR_CFG_PARAMS);
+    return ESP_OK;
+}
+
+/* Link watchdog: a stopped sensor is the only state it can be wedged in */
+static esp_err_t shs_sen0557_recover(uint8_t step)
+{
+    if (step != SHS_RADAR_RECOVER_END_CONFIG) return ESP_ERR_NOT_SUPPORTED;
+    ESP_LOGW(SHS_TAG, "Recovery: restart sensing");
+    shs_sen0557_cmd(SHS_SEN0557_CMD_START);
+    return ESP_OK;
+}
+
+static const uint32_t shs_sen0557_bauds[] = SHS_SEN0557_BAUD_CANDIDATES;
+
+const shs_radar_driver_t shs_radar_driver = {
+    .name            = "SEN0557",
+    .max_gate        = SHS_SEN0557_GATES - 1,
+    .min_static_gate = SHS_SEN0557_MIN_STATIC_GATE,
+    .frame_end_chr   = SHS_SEN0557_LINE_END,
+    .per_gate_thr    = false,
+    .fine_res        = false,
+    .has_distance    = false,
+    .default_baud    = SHS_SEN0557_BAUD_DEFAULT,
+    .bauds           = shs_sen0557_bauds,
+    .n_bauds         = sizeof(shs_sen0557_bauds) / sizeof(shs_sen0557_bauds[0]),
+    .upgrade_baud    = 0,
+    .probe_ms        = SHS_SEN0557_PROBE_MS,
+    .probe_frames    = SHS_SEN0557_PROBE_FRAMES,
+    .set_baud        = NULL,
+    .init            = shs_sen0557_init,
+    .feed            = shs_sen0557_feed,
+    .apply_config    = shs_sen0557_apply_config,
+    .recover         = shs_sen0557_recover,
+};
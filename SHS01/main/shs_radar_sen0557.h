@@ -0,0 +1,42 @@
+/*
+ * SPDX-FileCopyrightText: 2021-2025
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+#ifndef SHS_RADAR_SEN0557_H
+#define SHS_RADAR_SEN0557_H
+
+/* ---------------- DFRobot SEN0557 (leapMMW text protocol) ----------------
+ * Presence lines:  "$JYBSS,<0|1>, , , *\r\n"
+ * Commands:        "<cmd> [args]\r\n", answered by "Done" / "Error" lines */
+#define SHS_SEN0557_LINE_START          '$'
+#define SHS_SEN0557_LINE_END            '\n'
+#define SHS_SEN0557_REPORT_TAG          "$JYBSS,"
+#define SHS_SEN0557_REPORT_TAG_LEN      7
+#define SHS_SEN0557_REPORT_STOP         '*'
+#define SHS_SEN0557_MAX_LINE            64      /* longer runs without '\n' are noise */
+
+/* Commands */
+#define SHS_SEN0557_CMD_STOP            "sensorStop"
+#define SHS_SEN0557_CMD_START           "sensorStart"
+#define SHS_SEN0557_CMD_SAVE            "saveConfig"
+#define SHS_SEN0557_CMD_SENSITIVITY     "setSensitivity"    /* 0..9 */
+#define SHS_SEN0557_CMD_RANGE           "setRange"          /* <min m> <max m> */
+#define SHS_SEN0557_CMD_LATENCY         "setLatency"        /* <detect s> <clear s> */
+#define SHS_SEN0557_CMD_UART_OUTPUT     "setUartOutput"     /* 1 1: stream $JYBSS lines */
+#define SHS_SEN0557_CMD_GAP_MS          100                 /* module needs time per command */
+
+/* Limits */
+#define SHS_SEN0557_SENS_MAX            9
+#define SHS_SEN0557_CM_PER_GATE         SHS_RADAR_GATE_CM  /* same gate scale as the config cluster */
+#define SHS_SEN0557_GATES               9       /* 0..6.0 m */
+#define SHS_SEN0557_MIN_STATIC_GATE     1
+#define SHS_SEN0557_LATENCY_MAX_S       1500
+
+/* Baud */
+#define SHS_SEN0557_BAUD_DEFAULT        57600
+#define SHS_SEN0557_BAUD_CANDIDATES     { 57600, 115200, 9600 }
+#define SHS_SEN0557_PROBE_MS            2500    /* $JYBSS lines come about once a second */
+#define SHS_SEN0557_PROBE_FRAMES        1       /* a whole tagged line cannot be line noise */
+
+#endif /* SHS_RADAR_SEN0557_H */
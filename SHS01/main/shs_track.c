@@ -0,0 +1,86 @@
+/*
+ * SPDX-FileCopyrightText: 2021-2025
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "shs_track.h"
+
+void shs_track_reset(shs_track_t *t)
+{
+    t->valid = false;
+    t->updates = 0;
+    t->dir = SHS_TRACK_NONE;
+    t->r_q8 = 0;
+    t->v_q8 = 0;
+}
+
+static void shs_track_start(shs_track_t *t, uint16_t dist_cm, uint32_t now_ms)
+{
+    t->valid = true;
+    t->updates = 1;
+    t->dir = SHS_TRACK_NONE;
+    t->r_q8 = (int32_t)dist_cm << 8;
+    t->v_q8 = 0;
+    t->t_ms = now_ms;
+}
+
+/* Direction with hysteresis so a target hovering around the threshold does not flap */
+static uint8_t shs_track_classify(const shs_track_t *t)
+{
+    if (t->updates < SHS_TRACK_MIN_UPDATES) return SHS_TRACK_NONE;
+
+    int32_t v = shs_track_speed_cm_s(t);
+    switch (t->dir) {
+        case SHS_TRACK_APPROACHING:
+            if (v < -SHS_TRACK_MOVE_EXIT_CM_S) return SHS_TRACK_APPROACHING;
+            break;
+        case SHS_TRACK_DEPARTING:
+            if (v > SHS_TRACK_MOVE_EXIT_CM_S) return SHS_TRACK_DEPARTING;
+            break;
+        default:
+            break;
+    }
+    if (v <= -SHS_TRACK_MOVE_ENTER_CM_S) return SHS_TRACK_APPROACHING;
+    if (v >= SHS_TRACK_MOVE_ENTER_CM_S) return SHS_TRACK_DEPARTING;
+    return SHS_TRACK_STATIONARY;
+}
+
+void shs_track_update(shs_track_t *t, bool has_target, uint16_t dist_cm, uint32_t now_ms)
+{
+    if (!has_target) {
+        if (t->valid && (int32_t)(now_ms - t->t_ms) >= SHS_TRACK_LOST_MS) shs_track_reset(t);
+        return;
+    }
+    if (!t->valid) {
+        shs_track_start(t, dist_cm, now_ms);
+        return;
+    }
+
+    uint32_t dt_ms = now_ms - t->t_ms;
+    if (dt_ms == 0) return;
+    if (dt_ms >= SHS_TRACK_LOST_MS) {
+        shs_track_start(t, dist_cm, now_ms);
+        return;
+    }
+
+    /* predict, then correct by the residual */
+    int32_t pred_q8 = t->r_q8 + (int32_t)(((int64_t)t->v_q8 * dt_ms) / 1000);
+    int32_t res_q8 = ((int32_t)dist_cm << 8) - pred_q8;
+    if (res_q8 > (SHS_TRACK_GATE_CM << 8) || res_q8 < -(SHS_TRACK_GATE_CM << 8)) {
+        shs_track_start(t, dist_cm, now_ms);
+        return;
+    }
+    t->r_q8 = pred_q8 + (int32_t)(((int64_t)SHS_TRACK_ALPHA_Q8 * res_q8) >> 8);
+    t->v_q8 += (int32_t)(((int64_t)SHS_TRACK_BETA_Q8 * res_q8 * 1000) / ((int64_t)256 * dt_ms));
+    t->t_ms = now_ms;
+    if (t->updates < UINT8_MAX) t->updates++;
+    t->dir = shs_track_classify(t);
+}
+
+int32_t shs_track_predict_cm(const shs_track_t *t, uint32_t lead_ms)
+{
+    return (t->r_q8 + (int32_t)(((int64_t)t->v_q8 * lead_ms) / 1000)) >> 8;
+}
@@ -0,0 +1,49 @@
+/*
+ * SPDX-FileCopyrightText: 2021-2025
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+#ifndef SHS_TRACK_H
+#define SHS_TRACK_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* ---------------- Alpha-beta range tracker ----------------
+ * Smooths the reported target distance and estimates its radial speed.
+ * Fixed point: range in cm and speed in cm/s, both Q8; gains are Q8
+ * fractions. Runs once per processed frame on the radar task. */
+#define SHS_TRACK_ALPHA_Q8              128     /* 0.5: range follows a measurement by half the residual */
+#define SHS_TRACK_BETA_Q8               26      /* ~0.1: speed correction per residual */
+#define SHS_TRACK_GATE_CM               150     /* residual beyond this is a different target: restart */
+#define SHS_TRACK_LOST_MS               1500    /* no target for this long drops the track */
+#define SHS_TRACK_MIN_UPDATES           3       /* updates before a direction is reported */
+#define SHS_TRACK_MOVE_ENTER_CM_S       25      /* |speed| to start approaching / departing */
+#define SHS_TRACK_MOVE_EXIT_CM_S        10      /* |speed| to fall back to stationary */
+
+typedef enum {
+    SHS_TRACK_NONE        = 0,  /* no target tracked */
+    SHS_TRACK_STATIONARY  = 1,
+    SHS_TRACK_APPROACHING = 2,
+    SHS_TRACK_DEPARTING   = 3,
+} shs_track_dir_t;
+
+typedef struct {
+    bool     valid;
+    uint8_t  updates;           /* saturating */
+    uint8_t  dir;               /* shs_track_dir_t */
+    int32_t  r_q8;              /* range, cm Q8 */
+    int32_t  v_q8;              /* radial speed, cm/s Q8; negative = approaching */
+    uint32_t t_ms;              /* time of the last update */
+} shs_track_t;
+
+void shs_track_reset(shs_track_t *t);
+/* One frame: has_target false ages the track out after SHS_TRACK_LOST_MS */
+void shs_track_update(shs_track_t *t, bool has_target, uint16_t dist_cm, uint32_t now_ms);
+
+static inline int32_t shs_track_range_cm(const shs_track_t *t) { return t->r_q8 >> 8; }
+static inline int32_t shs_track_speed_cm_s(const shs_track_t *t) { return t->v_q8 / 256; }
+/* Range expected lead_ms after the last update */
+int32_t shs_track_predict_cm(const shs_track_t *t, uint32_t lead_ms);
+
+#endif /* SHS_TRACK_H */
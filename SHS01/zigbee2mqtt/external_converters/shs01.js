@@ -11,6 +11,8 @@ const ea = exposes.access;
 
 const EP1 = 1;                   // light + config
 const EP2 = 2;                   // occupancy (overall + moving/static)
+const EP_ZONE_BASE = 3;          // + zone: occupancy per distance zone
+const ZONES = 4;
 
 const CL_CFG = 0xFDCD;           // custom config (EP1)
 const CL_OCC = 0x0406;           // msOccupancySensing (EP2)
@@ -21,16 +23,109 @@ const ATTR_MOVING_SENS_0_10   = 0x0003;
 const ATTR_STATIC_SENS_0_10   = 0x0004;
 const ATTR_MOVING_MAX_GATE    = 0x0005;
 const ATTR_STATIC_MAX_GATE    = 0x0006;
+const ATTR_DIST_RESOLUTION    = 0x0007; // U16 0 = 0.75 m gates, 1 = 0.2 m, SHS01 only
+const ATTR_CALIBRATE          = 0x0008; // U16 window s (write to start, 0 cancels), per-gate models
+const ATTR_MOVING_ASSERT_MS   = 0x0009; // U16 firmware hold delays; moving clear = ATTR_MOVEMENT_COOLDOWN
+const ATTR_STATIC_ASSERT_MS   = 0x000A;
+const ATTR_STATIC_CLEAR_S     = 0x000B;
+const ATTR_OCC_ASSERT_MS      = 0x000C;
+const ATTR_OCC_CLEAR_S        = 0x000D;
+const ATTR_PRETRIGGER_CM      = 0x000E; // U16 cm, 0 = off
+const ATTR_INTERF_SUPPRESS    = 0x000F; // U16 0/1
+const ATTR_ZONE_BASE          = 0x0050; // + 4 * zone + field: U16 start cm, end cm (0 = off), clear s
+const ATTR_MV_GATE_THR_BASE   = 0x0010; // + gate, U16 0..100 (0 = global)
+const ATTR_ST_GATE_THR_BASE   = 0x0030;
+
+const ATTR_DIAG_GOOD_FRAMES   = 0x0100; // read-only U32 parser counters (EP1)
+const ATTR_DIAG_BAD_FRAMES    = 0x0101;
+const ATTR_DIAG_RESYNCS       = 0x0102;
+const ATTR_DIAG_DROPPED_BYTES = 0x0103;
+const ATTR_DIAG_DUP_FRAMES    = 0x0104;
+const ATTR_DIAG_CMD_FAILURES  = 0x0105; // radar commands NAKed / never ACKed
+const ATTR_DIAG_CMD_RETRIES   = 0x0106;
+const ATTR_DIAG_CMD_RTT_MAX   = 0x0107; // ms
+const ATTR_DIAG_LINK_STATE    = 0x0108; // 0 up, 1 recovering, 2 down (reportable)
+const ATTR_DIAG_LINK_LOSSES   = 0x0109;
+const ATTR_DIAG_LINK_RECOVERIES = 0x010A;
+const ATTR_DIAG_DRIFT_EVENTS  = 0x010B;
+const ATTR_DIAG_INTERF_GATES  = 0x010C; // bitmask of gates masked as interferers
+const ATTR_DIAG_INTERF_SUPPRESSED = 0x010D;
+const DIAG_ATTRS = [ATTR_DIAG_GOOD_FRAMES, ATTR_DIAG_BAD_FRAMES, ATTR_DIAG_RESYNCS, ATTR_DIAG_DROPPED_BYTES, ATTR_DIAG_DUP_FRAMES,
+                    ATTR_DIAG_CMD_FAILURES, ATTR_DIAG_CMD_RETRIES, ATTR_DIAG_CMD_RTT_MAX,
+                    ATTR_DIAG_LINK_STATE, ATTR_DIAG_LINK_LOSSES, ATTR_DIAG_LINK_RECOVERIES, ATTR_DIAG_DRIFT_EVENTS,
+                    ATTR_DIAG_INTERF_GATES, ATTR_DIAG_INTERF_SUPPRESSED];
+const LINK_STATES = ['up', 'recovering', 'down'];
 
 const ATTR_MOVING_TARGET = 0xF001; // mfg bool in CL_OCC (EP2)
 const ATTR_STATIC_TARGET = 0xF002; // mfg bool in CL_OCC (EP2)
+const ATTR_TARGET_DIR    = 0xF003; // mfg U8 in CL_OCC (EP2), index into TARGET_DIRS
+const TARGET_DIRS = ['none', 'stationary', 'approaching', 'departing'];
+const ATTR_CONFIDENCE    = 0xF004; // mfg U8 in CL_OCC (EP2), 0..100
+const CONFIDENCE_CHANGE  = 5;      // reportable change, matches the device's publish step
+
+const U8 = 0x20, U16 = 0x21, BOOL_DT = 0x10;
+
+// Distance zones: zone_<n>_start / zone_<n>_end in m, zone_<n>_clear_delay in s
+const ZONE_FIELDS = [
+  {suffix: 'start', field: 0},
+  {suffix: 'end', field: 1},
+  {suffix: 'clear_delay', field: 2},
+];
+const zoneKeys = () => {
+  const keys = [];
+  for (let z = 1; z <= ZONES; z++) for (const f of ZONE_FIELDS) keys.push(`zone_${z}_${f.suffix}`);
+  return keys;
+};
+const zoneAttr = (key) => {
+  const [, z, suffix] = key.match(/^zone_(\d)_(.+)$/);
+  return ATTR_ZONE_BASE + 4 * (Number(z) - 1) + ZONE_FIELDS.find((f) => f.suffix === suffix).field;
+};
+const zoneAttrs = () => zoneKeys().map(zoneAttr);
+
+// Masked interferer gates as a readable list, e.g. "3,5" ('' = none)
+const maskToGates = (mask) => {
+  const gates = [];
+  for (let g = 0; g < 32; g++) if (mask & (1 << g)) gates.push(g);
+  return gates.join(',');
+};
 
-const U16 = 0x21, BOOL_DT = 0x10;
+// Hold delays: a state is reported only after the raw detection held for this long
+const HOLD = [
+  {key: 'movement_assert_delay',  attr: ATTR_MOVING_ASSERT_MS, unit: 'ms', max: 10000, what: 'Moving target must persist this long before it is reported'},
+  {key: 'static_assert_delay',    attr: ATTR_STATIC_ASSERT_MS, unit: 'ms', max: 10000, what: 'Static target must persist this long before it is reported'},
+  {key: 'static_clear_delay',     attr: ATTR_STATIC_CLEAR_S,   unit: 's',  max: 300,   what: 'Static target must be gone this long before it clears'},
+  {key: 'occupancy_assert_delay', attr: ATTR_OCC_ASSERT_MS,    unit: 'ms', max: 10000, what: 'Presence must persist this long before occupancy is reported'},
+  {key: 'occupancy_clear_delay',  attr: ATTR_OCC_CLEAR_S,      unit: 's',  max: 300,   what: 'Presence must be gone this long before occupancy clears (on top of the radar\'s own delay)'},
+];
 const clamp = (v, lo, hi) => Math.max(lo, Math.min(hi, Number(v)));
-const M_PER_GATE = 0.75;
-const gateToM = (g) => Number((Math.max(0, Math.min(8, Number(g))) * M_PER_GATE).toFixed(2));
-const mToGateMv = (m) => Math.max(0, Math.min(8, Math.round(Number(m) / M_PER_GATE)));
-const mToGateSt = (m) => Math.max(2, Math.min(8, Math.round(Number(m) / M_PER_GATE)));
+const M_PER_GATE = 0.75, M_PER_GATE_FINE = 0.2;
+const RESOLUTIONS = ['0.75m', '0.2m'];   // index = ATTR_DIST_RESOLUTION value
+
+// Gate limits per model: SHS01 = LD2410 (gates 0..8, 0.2 m mode), SHS02 = LD2412 (gates 0..13),
+// SHS03 = SEN0557 (one range and sensitivity, mapped onto 0.75 m gates 1..8; no distances, so no
+// zones, tracking or pre-trigger)
+const GATES = {
+  SHS01: {max: 8, minStatic: 2, perGate: true, fineRes: true, hasDistance: true},
+  SHS02: {max: 13, minStatic: 1, perGate: true, fineRes: false, hasDistance: true},
+  SHS03: {max: 8, minStatic: 1, perGate: false, fineRes: false, hasDistance: false},
+};
+const gatesOf = (model) => GATES[model?.model] ?? GATES.SHS01;
+// Gate size follows the device's resolution: from the message itself, else the last published state
+const mPerGate = (res) => (res === 1 || res === RESOLUTIONS[1]) ? M_PER_GATE_FINE : M_PER_GATE;
+// Far end of the last gate: limit for zone edges and the pre-trigger distance
+const zoneMaxM = (G, mpg) => (G.max + 1) * mpg;
+const gateToM = (g, G, mpg) => Number((Math.max(0, Math.min(G.max, Number(g))) * mpg).toFixed(2));
+const mToGateMv = (m, G, mpg) => Math.max(0, Math.min(G.max, Math.round(Number(m) / mpg)));
+const mToGateSt = (m, G, mpg) => Math.max(G.minStatic, Math.min(G.max, Math.round(Number(m) / mpg)));
+const gateThrKeys = (G) => {
+  const keys = [];
+  for (let g = 0; g <= G.max; g++) keys.push(`movement_gate_${g}_threshold`, `occupancy_gate_${g}_threshold`);
+  return keys;
+};
+const gateThrAttr = (key) => {
+  const m = /^(movement|occupancy)_gate_(\d+)_threshold$/.exec(key);
+  return m ? (m[1] === 'movement' ? ATTR_MV_GATE_THR_BASE : ATTR_ST_GATE_THR_BASE) + Number(m[2]) : undefined;
+};
 
 const fzLocal = {
   occ_ep2: {
@@ -45,21 +140,66 @@ const fzLocal = {
       const st = d[ATTR_STATIC_TARGET] ?? d[String(ATTR_STATIC_TARGET)];
       if (mv !== undefined) out['moving_target'] = (mv === true || mv === 1);
       if (st !== undefined) out['static_target'] = (st === true || st === 1);
+      const dir = d[ATTR_TARGET_DIR] ?? d[String(ATTR_TARGET_DIR)];
+      if (dir !== undefined) out['target_direction'] = TARGET_DIRS[dir] ?? 'none';
+      const conf = d[ATTR_CONFIDENCE] ?? d[String(ATTR_CONFIDENCE)];
+      if (conf !== undefined) out['presence_confidence'] = conf;
       return out;
     },
   },
+  occ_zones: {
+    cluster: 'msOccupancySensing',
+    type: ['attributeReport', 'readResponse'],
+    convert: (_model, msg) => {
+      const z = (msg.endpoint?.ID ?? 0) - EP_ZONE_BASE;
+      if (z < 0 || z >= ZONES) return {};
+      const occ = msg.data?.occupancy ?? msg.data?.['0'];
+      if (occ === undefined) return {};
+      return {[`zone_${z + 1}_occupancy`]: (typeof occ === 'number') ? ((occ & 1) === 1) : !!occ};
+    },
+  },
   cfg_ep1: {
     cluster: CL_CFG,
     type: ['readResponse', 'attributeReport'],
-    convert: (_model, msg) => {
+    convert: (model, msg, _publish, _options, meta) => {
       if (msg.endpoint?.ID !== EP1) return {};
-      const d = msg.data || {}, out = {};
+      const d = msg.data || {}, out = {}, G = gatesOf(model);
+      const mpg = mPerGate(d[ATTR_DIST_RESOLUTION] ?? meta?.state?.distance_resolution);
+      if (G.fineRes && d[ATTR_DIST_RESOLUTION] !== undefined) out['distance_resolution'] = RESOLUTIONS[d[ATTR_DIST_RESOLUTION] ? 1 : 0];
       if (d[ATTR_MOVEMENT_COOLDOWN]   !== undefined) out['movement_clear_cooldown']       = d[ATTR_MOVEMENT_COOLDOWN];
       if (d[ATTR_OCC_CLEAR_COOLDOWN]  !== undefined) out['occupancy_clear_cooldown']       = d[ATTR_OCC_CLEAR_COOLDOWN];
+      for (const h of HOLD) if (d[h.attr] !== undefined) out[h.key] = d[h.attr];
+      if (d[ATTR_PRETRIGGER_CM]       !== undefined) out['pre_trigger_distance']                = d[ATTR_PRETRIGGER_CM] / 100;
+      for (const key of zoneKeys()) {
+        const v = d[zoneAttr(key)];
+        if (v !== undefined) out[key] = key.endsWith('_clear_delay') ? v : v / 100;
+      }
       if (d[ATTR_MOVING_SENS_0_10]    !== undefined) out['movement_detection_sensitivity']      = d[ATTR_MOVING_SENS_0_10];
       if (d[ATTR_STATIC_SENS_0_10]    !== undefined) out['occupancy_detection_sensitivity']        = d[ATTR_STATIC_SENS_0_10];
-      if (d[ATTR_MOVING_MAX_GATE]     !== undefined) out['movement_detection_range']            = gateToM(d[ATTR_MOVING_MAX_GATE]);
-      if (d[ATTR_STATIC_MAX_GATE]     !== undefined) out['occupancy_detection_range']              = gateToM(d[ATTR_STATIC_MAX_GATE]);
+      if (d[ATTR_MOVING_MAX_GATE]     !== undefined) out['movement_detection_range']            = gateToM(d[ATTR_MOVING_MAX_GATE], G, mpg);
+      if (d[ATTR_STATIC_MAX_GATE]     !== undefined) out['occupancy_detection_range']              = gateToM(d[ATTR_STATIC_MAX_GATE], G, mpg);
+      if (d[ATTR_DIAG_GOOD_FRAMES]    !== undefined) out['radar_frames_good']                   = d[ATTR_DIAG_GOOD_FRAMES];
+      if (d[ATTR_DIAG_BAD_FRAMES]     !== undefined) out['radar_frames_bad']                    = d[ATTR_DIAG_BAD_FRAMES];
+      if (d[ATTR_DIAG_RESYNCS]        !== undefined) out['radar_resyncs']                       = d[ATTR_DIAG_RESYNCS];
+      if (d[ATTR_DIAG_DROPPED_BYTES]  !== undefined) out['radar_dropped_bytes']                 = d[ATTR_DIAG_DROPPED_BYTES];
+      if (d[ATTR_DIAG_DUP_FRAMES]     !== undefined) out['radar_duplicate_frames']              = d[ATTR_DIAG_DUP_FRAMES];
+      if (d[ATTR_DIAG_CMD_FAILURES]   !== undefined) out['radar_command_failures']              = d[ATTR_DIAG_CMD_FAILURES];
+      if (d[ATTR_DIAG_CMD_RETRIES]    !== undefined) out['radar_command_retries']               = d[ATTR_DIAG_CMD_RETRIES];
+      if (d[ATTR_DIAG_CMD_RTT_MAX]    !== undefined) out['radar_command_rtt_max']               = d[ATTR_DIAG_CMD_RTT_MAX];
+      if (d[ATTR_DIAG_LINK_STATE]     !== undefined) out['radar_link_state']                    = LINK_STATES[d[ATTR_DIAG_LINK_STATE]] ?? 'down';
+      if (d[ATTR_DIAG_LINK_LOSSES]    !== undefined) out['radar_link_losses']                   = d[ATTR_DIAG_LINK_LOSSES];
+      if (d[ATTR_DIAG_LINK_RECOVERIES] !== undefined) out['radar_link_recoveries']              = d[ATTR_DIAG_LINK_RECOVERIES];
+      if (d[ATTR_DIAG_DRIFT_EVENTS]   !== undefined) out['radar_config_drifts']                 = d[ATTR_DIAG_DRIFT_EVENTS];
+      if (d[ATTR_DIAG_INTERF_GATES]   !== undefined) out['interference_gates']                  = maskToGates(d[ATTR_DIAG_INTERF_GATES]);
+      if (d[ATTR_DIAG_INTERF_SUPPRESSED] !== undefined) out['interference_suppressed']          = d[ATTR_DIAG_INTERF_SUPPRESSED];
+      if (d[ATTR_INTERF_SUPPRESS]     !== undefined) out['interference_suppression']            = d[ATTR_INTERF_SUPPRESS] ? 'ON' : 'OFF';
+      if (G.perGate && d[ATTR_CALIBRATE] !== undefined) out['empty_room_calibration'] = d[ATTR_CALIBRATE];
+      if (G.perGate) {
+        for (let g = 0; g <= G.max; g++) {
+          if (d[ATTR_MV_GATE_THR_BASE + g] !== undefined) out[`movement_gate_${g}_threshold`]  = d[ATTR_MV_GATE_THR_BASE + g];
+          if (d[ATTR_ST_GATE_THR_BASE + g] !== undefined) out[`occupancy_gate_${g}_threshold`] = d[ATTR_ST_GATE_THR_BASE + g];
+        }
+      }
       return out;
     },
   },
@@ -76,6 +216,46 @@ const tzLocal = {
     },
     convertGet: async (_e, _k, meta) => tzLocal._ep1(meta).read(CL_CFG, [ATTR_MOVEMENT_COOLDOWN]),
   },
+  'hold_delays': {
+    key: HOLD.map((h) => h.key),
+    convertSet: async (_e, key, v, meta) => {
+      const h = HOLD.find((x) => x.key === key);
+      const val = clamp(v, 0, h.max);
+      await tzLocal._ep1(meta).write(CL_CFG, { [h.attr]: { value: val, type: U16 } });
+      return { state: { [key]: val } };
+    },
+    convertGet: async (_e, key, meta) => tzLocal._ep1(meta).read(CL_CFG, [HOLD.find((x) => x.key === key).attr]),
+  },
+  'pre_trigger_distance': {
+    key: ['pre_trigger_distance'],
+    convertSet: async (_e, _k, v, meta) => {
+      const G = gatesOf(meta.mapped), mpg = mPerGate(meta.state?.distance_resolution);
+      const cm = Math.round(clamp(v, 0, zoneMaxM(G, mpg)) * 100);
+      await tzLocal._ep1(meta).write(CL_CFG, { [ATTR_PRETRIGGER_CM]: { value: cm, type: U16 } });
+      return { state: { 'pre_trigger_distance': cm / 100 } };
+    },
+    convertGet: async (_e, _k, meta) => tzLocal._ep1(meta).read(CL_CFG, [ATTR_PRETRIGGER_CM]),
+  },
+  'interference_suppression': {
+    key: ['interference_suppression'],
+    convertSet: async (_e, _k, v, meta) => {
+      const on = v === true || String(v).toUpperCase() === 'ON';
+      await tzLocal._ep1(meta).write(CL_CFG, { [ATTR_INTERF_SUPPRESS]: { value: on ? 1 : 0, type: U16 } });
+      return { state: { 'interference_suppression': on ? 'ON' : 'OFF' } };
+    },
+    convertGet: async (_e, _k, meta) => tzLocal._ep1(meta).read(CL_CFG, [ATTR_INTERF_SUPPRESS]),
+  },
+  'zones': {
+    key: zoneKeys(),
+    convertSet: async (_e, key, v, meta) => {
+      const delay = key.endsWith('_clear_delay');
+      const G = gatesOf(meta.mapped), mpg = mPerGate(meta.state?.distance_resolution);
+      const raw = delay ? clamp(v, 0, 300) : Math.round(clamp(v, 0, zoneMaxM(G, mpg)) * 100);
+      await tzLocal._ep1(meta).write(CL_CFG, { [zoneAttr(key)]: { value: raw, type: U16 } });
+      return { state: { [key]: delay ? raw : raw / 100 } };
+    },
+    convertGet: async (_e, key, meta) => tzLocal._ep1(meta).read(CL_CFG, [zoneAttr(key)]),
+  },
   'occupancy_clear_cooldown': {
     key: ['occupancy_clear_cooldown'],
     convertSet: async (_e, _k, v, meta) => {
@@ -106,93 +286,229 @@ const tzLocal = {
   'movement_detection_range': {
     key: ['movement_detection_range'],
     convertSet: async (_e, _k, v, meta) => {
-      const gate = mToGateMv(clamp(v, 0.0, 6.0));
+      const G = gatesOf(meta.mapped), mpg = mPerGate(meta.state?.distance_resolution);
+      const gate = mToGateMv(clamp(v, 0.0, G.max * mpg), G, mpg);
       await tzLocal._ep1(meta).write(CL_CFG, { [ATTR_MOVING_MAX_GATE]: { value: gate, type: U16 } });
-      return { state: { 'movement_detection_range': gateToM(gate) } };
+      return { state: { 'movement_detection_range': gateToM(gate, G, mpg) } };
     },
     convertGet: async (_e, _k, meta) => tzLocal._ep1(meta).read(CL_CFG, [ATTR_MOVING_MAX_GATE]),
   },
   'occupancy_detection_range': {
     key: ['occupancy_detection_range'],
     convertSet: async (_e, _k, v, meta) => {
-      const gate = mToGateSt(clamp(v, 0.75, 6.0));
+      const G = gatesOf(meta.mapped), mpg = mPerGate(meta.state?.distance_resolution);
+      const gate = mToGateSt(clamp(v, G.minStatic * mpg, G.max * mpg), G, mpg);
       await tzLocal._ep1(meta).write(CL_CFG, { [ATTR_STATIC_MAX_GATE]: { value: gate, type: U16 } });
-      return { state: { 'occupancy_detection_range': gateToM(gate) } };
+      return { state: { 'occupancy_detection_range': gateToM(gate, G, mpg) } };
     },
     convertGet: async (_e, _k, meta) => tzLocal._ep1(meta).read(CL_CFG, [ATTR_STATIC_MAX_GATE]),
   },
+  'distance_resolution': {
+    key: ['distance_resolution'],
+    convertSet: async (_e, _k, v, meta) => {
+      const res = RESOLUTIONS.indexOf(v) === 1 ? 1 : 0;
+      const ep1 = tzLocal._ep1(meta);
+      await ep1.write(CL_CFG, { [ATTR_DIST_RESOLUTION]: { value: res, type: U16 } });
+      // gate indices are unchanged: re-read so the ranges are republished in the new scale
+      try { await ep1.read(CL_CFG, [ATTR_DIST_RESOLUTION, ATTR_MOVING_MAX_GATE, ATTR_STATIC_MAX_GATE]); } catch {}
+      return { state: { 'distance_resolution': RESOLUTIONS[res] } };
+    },
+    convertGet: async (_e, _k, meta) => tzLocal._ep1(meta).read(CL_CFG, [ATTR_DIST_RESOLUTION]),
+  },
+  'empty_room_calibration': {
+    key: ['empty_room_calibration'],
+    convertSet: async (_e, _k, v, meta) => {
+      const sec = Number(v) > 0 ? clamp(v, 10, 600) : 0;
+      await tzLocal._ep1(meta).write(CL_CFG, { [ATTR_CALIBRATE]: { value: sec, type: U16 } });
+      return { state: { 'empty_room_calibration': sec } };
+    },
+    convertGet: async (_e, _k, meta) => tzLocal._ep1(meta).read(CL_CFG, [ATTR_CALIBRATE]),
+  },
+  'gate_thresholds': {
+    key: gateThrKeys(GATES.SHS02),
+    convertSet: async (_e, key, v, meta) => {
+      const val = clamp(v, 0, 100);
+      await tzLocal._ep1(meta).write(CL_CFG, { [gateThrAttr(key)]: { value: val, type: U16 } });
+      return { state: { [key]: val } };
+    },
+    convertGet: async (_e, key, meta) => tzLocal._ep1(meta).read(CL_CFG, [gateThrAttr(key)]),
+  },
+  'radar_diagnostics': {
+    key: ['radar_frames_good', 'radar_frames_bad', 'radar_resyncs', 'radar_dropped_bytes', 'radar_duplicate_frames',
+          'radar_command_failures', 'radar_command_retries', 'radar_command_rtt_max',
+          'radar_link_state', 'radar_link_losses', 'radar_link_recoveries', 'radar_config_drifts',
+          'interference_gates', 'interference_suppressed'],
+    convertGet: async (_e, _k, meta) => {
+      // U32 results are 8 bytes each: keep every response inside one frame
+      for (let i = 0; i < DIAG_ATTRS.length; i += 6) await tzLocal._ep1(meta).read(CL_CFG, DIAG_ATTRS.slice(i, i + 6));
+    },
+  },
+};
+
+// SHS01, SHS02 and SHS03 share everything but the radar's gate limits
+const definition = (model, description) => {
+  const G = GATES[model];
+  const maxM = G.max * M_PER_GATE, minStM = G.minStatic * (G.fineRes ? M_PER_GATE_FINE : M_PER_GATE);
+  const rangeStep = G.fineRes ? 0.05 : M_PER_GATE;  // both gate sizes are multiples of 5 cm
+  const resExposes = !G.fineRes ? [] : [
+    exposes.enum('distance_resolution', ea.ALL, RESOLUTIONS).withCategory("config")
+      .withDescription("Radar gate size; ranges and gate thresholds scale with it (module restarts on change)")];
+  // widest range (0.75 m gates); writes are clamped to the current gate size
+  const distMaxM = zoneMaxM(G, M_PER_GATE);
+  const distExposes = !G.hasDistance ? [] : [
+    exposes.enum('target_direction', ea.STATE, TARGET_DIRS).withDescription("Tracked target: approaching, departing or stationary"),
+    exposes.numeric('pre_trigger_distance', ea.ALL).withUnit('m').withCategory("config").withValueMin(0).withValueMax(distMaxM).withValueStep(0.05)
+      .withDescription("Report occupancy early when an approaching target will be this close within half a second (0 = off)"),
+  ];
+  const zoneExposes = [];
+  for (let z = 1; z <= ZONES && G.hasDistance; z++) {
+    zoneExposes.push(
+      e.binary(`zone_${z}_occupancy`, ea.STATE, true, false).withDescription(`Presence inside distance zone ${z}`),
+      exposes.numeric(`zone_${z}_start`, ea.ALL).withUnit('m').withCategory("config").withValueMin(0).withValueMax(distMaxM).withValueStep(0.05)
+        .withDescription(`Zone ${z} near edge`),
+      exposes.numeric(`zone_${z}_end`, ea.ALL).withUnit('m').withCategory("config").withValueMin(0).withValueMax(distMaxM).withValueStep(0.05)
+        .withDescription(`Zone ${z} far edge (0 = zone off)`),
+      exposes.numeric(`zone_${z}_clear_delay`, ea.ALL).withUnit('s').withCategory("config").withValueMin(0).withValueMax(300)
+        .withDescription(`Zone ${z} must be empty this long before it clears`));
+  }
+  const gateExposes = !G.perGate ? [] : [
+    exposes.numeric('empty_room_calibration', ea.ALL).withUnit('s').withCategory("config").withValueMin(0).withValueMax(600)
+      .withDescription("Write a window (10-600 s) to calibrate gate thresholds in an empty room; starts 15 s later, 0 cancels, reads 0 when done"),
+    ...gateThrKeys(G).map((key) =>
+      exposes.numeric(key, ea.ALL).withCategory("config").withValueMin(0).withValueMax(100)
+        .withDescription("Energy threshold for this gate (0 = use the detection sensitivity)")),
+  ];
+
+  return {
+    serverModuleFormat: 'cjs',
+    fingerprint: [{modelID: model, manufacturerName: 'SmartHomeScene'}],
+    model,
+    icon: 'http://zigbee2mqtt.ourhome.co.za:8180/device_icons/ld2410.png',
+    vendor: 'SmartHomeScene',
+    description,
+    meta: {configureKey: 36, multiEndpoint: true},
+
+    // Only numeric endpoints come from the device itself (1, 2, 242)
+
+    fromZigbee: [
+      fz.on_off,        // EP1
+      fzLocal.occ_ep2,  // EP2
+      ...(G.hasDistance ? [fzLocal.occ_zones] : []), // EP3..EP6
+      fzLocal.cfg_ep1,  // EP1 config readback
+    ],
+    toZigbee: [
+      tz.on_off,                              // EP1
+      tzLocal['movement_clear_cooldown'],
+      tzLocal['occupancy_clear_cooldown'],
+      tzLocal['hold_delays'],
+      ...(G.hasDistance ? [tzLocal['zones'], tzLocal['pre_trigger_distance']] : []),
+      tzLocal['interference_suppression'],
+      tzLocal['movement_detection_sensitivity'],
+      tzLocal['occupancy_detection_sensitivity'],
+      tzLocal['movement_detection_range'],
+      tzLocal['occupancy_detection_range'],
+      ...(G.fineRes ? [tzLocal['distance_resolution']] : []),
+      ...(G.perGate ? [tzLocal['gate_thresholds'], tzLocal['empty_room_calibration']] : []),
+      tzLocal['radar_diagnostics'],
+    ],
+
+    exposes: [
+      e.light(),
+      e.binary('moving_target', ea.STATE, true, false).withDescription("Indicates whether the device detected movement"),
+      e.binary('static_target', ea.STATE, true, false).withDescription("Indicates whether the device detected peace"),
+      e.occupancy(),
+      exposes.numeric('presence_confidence', ea.STATE).withUnit('%').withValueMin(0).withValueMax(100)
+        .withDescription("How far detection energy is above (>= 50) or below (< 50) the configured thresholds, smoothed"),
+      ...distExposes,
+      exposes.numeric('movement_clear_cooldown', ea.ALL).withUnit('s').withCategory("config").withValueMin(0).withValueMax(300).withDescription("Movement clear time"),
+      exposes.numeric('occupancy_clear_cooldown', ea.ALL).withUnit('s').withCategory("config").withValueMin(0).withValueMax(65535).withDescription("Occupancy clear time"),
+      ...zoneExposes,
+      exposes.binary('interference_suppression', ea.ALL, 'ON', 'OFF').withCategory("config")
+        .withDescription("Learn gates with steady moving energy (fans, curtains, vents) and keep them from triggering movement (off by default)"),
+      ...HOLD.map((h) => exposes.numeric(h.key, ea.ALL).withUnit(h.unit).withCategory("config").withValueMin(0).withValueMax(h.max).withDescription(h.what)),
+      exposes.numeric('movement_detection_sensitivity', ea.ALL).withCategory("config").withValueMin(0).withValueMax(10).withDescription("Movement detection sensitivity"),
+      exposes.numeric('occupancy_detection_sensitivity', ea.ALL).withCategory("config").withValueMin(0).withValueMax(10).withDescription("Occupancy detection sensitivity"),
+      exposes.numeric('movement_detection_range', ea.ALL).withUnit('m').withCategory("config").withValueMin(0.0).withValueMax(maxM).withValueStep(rangeStep).withDescription("Movement detection range distance"),
+      exposes.numeric('occupancy_detection_range', ea.ALL).withUnit('m').withCategory("config").withValueMin(minStM).withValueMax(maxM).withValueStep(rangeStep).withDescription("Occupancy detection range distance"),
+      ...resExposes,
+      ...gateExposes,
+      exposes.numeric('radar_frames_good', ea.STATE_GET).withCategory("diagnostic").withDescription("Radar frames validated since boot"),
+      exposes.numeric('radar_frames_bad', ea.STATE_GET).withCategory("diagnostic").withDescription("Radar frames rejected by validation since boot"),
+      exposes.numeric('radar_resyncs', ea.STATE_GET).withCategory("diagnostic").withDescription("Radar stream resynchronisations since boot"),
+      exposes.numeric('radar_dropped_bytes', ea.STATE_GET).withCategory("diagnostic").withDescription("Radar bytes discarded outside valid frames since boot"),
+      exposes.numeric('radar_duplicate_frames', ea.STATE_GET).withCategory("diagnostic").withDescription("Unchanged radar frames skipped since boot"),
+      exposes.numeric('radar_command_failures', ea.STATE_GET).withCategory("diagnostic").withDescription("Radar config commands rejected or unacknowledged since boot"),
+      exposes.numeric('radar_command_retries', ea.STATE_GET).withCategory("diagnostic").withDescription("Radar config commands re-sent after an ACK timeout since boot"),
+      exposes.numeric('radar_command_rtt_max', ea.STATE_GET).withUnit('ms').withCategory("diagnostic").withDescription("Slowest radar command acknowledgement since boot"),
+      exposes.enum('radar_link_state', ea.STATE_GET, LINK_STATES).withCategory("diagnostic").withDescription("Radar UART link: up, recovering (watchdog steps running) or down"),
+      exposes.numeric('radar_link_losses', ea.STATE_GET).withCategory("diagnostic").withDescription("Times the radar stopped sending frames since boot"),
+      exposes.numeric('radar_link_recoveries', ea.STATE_GET).withCategory("diagnostic").withDescription("Watchdog recovery steps (end config, restart, re-apply) since boot"),
+      exposes.numeric('radar_config_drifts', ea.STATE_GET).withCategory("diagnostic").withDescription("Periodic read-backs that found the module config changed and re-applied it"),
+      exposes.text('interference_gates', ea.STATE_GET).withCategory("diagnostic").withDescription("Gates currently masked as interference sources"),
+      exposes.numeric('interference_suppressed', ea.STATE_GET).withCategory("diagnostic").withDescription("Frames whose moving target was dropped as interference since boot"),
+
+    ],
+
+    configure: async (device, coordinatorEndpoint) => {
+      const ep1 = device.getEndpoint(EP1);
+      const ep2 = device.getEndpoint(EP2);
+
+      await reporting.bind(ep1, coordinatorEndpoint, ['genOnOff']);
+      await reporting.bind(ep2, coordinatorEndpoint, ['msOccupancySensing']);
+
+      try { await ep1.configureReporting('genOnOff', [{attribute: 'onOff', minimumReportInterval: 0, maximumReportInterval: 3600}]); }
+      catch { try { await reporting.onOff(ep1); } catch {} }
+      try { await ep1.read('genOnOff', ['onOff']); } catch {}
+
+      try { await ep2.configureReporting('msOccupancySensing', [{attribute: 'occupancy', minimumReportInterval: 0, maximumReportInterval: 3600, reportableChange: 0}]); }
+      catch { try { await reporting.occupancy(ep2, {min: 0, max: 3600, change: 0}); } catch {} }
+
+      const repCustom = [
+        {attribute: ATTR_MOVING_TARGET, minimumReportInterval: 0, maximumReportInterval: 3600, reportableChange: 1, dataType: BOOL_DT},
+        {attribute: ATTR_STATIC_TARGET, minimumReportInterval: 0, maximumReportInterval: 3600, reportableChange: 1, dataType: BOOL_DT},
+        ...(G.hasDistance ? [{attribute: ATTR_TARGET_DIR, minimumReportInterval: 0, maximumReportInterval: 3600, reportableChange: 1, dataType: U8}] : []),
+        {attribute: ATTR_CONFIDENCE, minimumReportInterval: 1, maximumReportInterval: 3600, reportableChange: CONFIDENCE_CHANGE, dataType: U8},
+      ];
+      try { await ep2.configureReporting(CL_OCC, repCustom, {manufacturerCode: 0x115F}); }
+      catch { try { await ep2.configureReporting(CL_OCC, repCustom); } catch {} }
+
+      const repLink = [{attribute: ATTR_DIAG_LINK_STATE, minimumReportInterval: 0, maximumReportInterval: 3600, reportableChange: 1, dataType: 0x23}];
+      try { await reporting.bind(ep1, coordinatorEndpoint, [CL_CFG]); await ep1.configureReporting(CL_CFG, repLink); } catch {}
+
+      try { await ep2.read('msOccupancySensing', ['occupancy']); } catch {}
+      try { await ep2.read(CL_OCC, [ATTR_MOVING_TARGET, ATTR_STATIC_TARGET, ...(G.hasDistance ? [ATTR_TARGET_DIR] : []), ATTR_CONFIDENCE]); } catch {}
+
+      try {
+        await ep1.read(CL_CFG, [
+          ATTR_MOVEMENT_COOLDOWN, ATTR_OCC_CLEAR_COOLDOWN,
+          ATTR_MOVING_SENS_0_10, ATTR_STATIC_SENS_0_10,
+          ATTR_MOVING_MAX_GATE, ATTR_STATIC_MAX_GATE,
+          ...(G.fineRes ? [ATTR_DIST_RESOLUTION] : []),
+        ]);
+      } catch {}
+      try { await ep1.read(CL_CFG, [...HOLD.map((h) => h.attr), ...(G.hasDistance ? [ATTR_PRETRIGGER_CM] : []), ATTR_INTERF_SUPPRESS]); } catch {}
+      const za = G.hasDistance ? zoneAttrs() : [];
+      for (let i = 0; i < za.length; i += 6) { try { await ep1.read(CL_CFG, za.slice(i, i + 6)); } catch {} }
+      for (let z = 0; z < ZONES; z++) {
+        const ep = device.getEndpoint(EP_ZONE_BASE + z);
+        if (!ep) continue;
+        try {
+          await reporting.bind(ep, coordinatorEndpoint, ['msOccupancySensing']);
+          await ep.configureReporting('msOccupancySensing', [{attribute: 'occupancy', minimumReportInterval: 0, maximumReportInterval: 3600, reportableChange: 0}]);
+          await ep.read('msOccupancySensing', ['occupancy']);
+        } catch {}
+      }
+      if (G.perGate) {
+        const thr = [];
+        for (let g = 0; g <= G.max; g++) thr.push(ATTR_MV_GATE_THR_BASE + g, ATTR_ST_GATE_THR_BASE + g);
+        for (let i = 0; i < thr.length; i += 8) { try { await ep1.read(CL_CFG, thr.slice(i, i + 8)); } catch {} }
+      }
+    },
+  };
 };
 
-export default [{
-  serverModuleFormat: 'cjs',
-  fingerprint: [{modelID: 'SHS01', manufacturerName: 'SmartHomeScene'}],
-  model: 'SHS01',
-  icon: 'http://zigbee2mqtt.ourhome.co.za:8180/device_icons/ld2410.png',
-  vendor: 'SmartHomeScene',
-  description: 'ESP32-C6 LD2410C: light + Moving/Static/Occupancy + config (EP1/EP2)',
-  meta: {configureKey: 31, multiEndpoint: true},
-
-  // Only numeric endpoints come from the device itself (1, 2, 242)
-
-  fromZigbee: [
-    fz.on_off,        // EP1
-    fzLocal.occ_ep2,  // EP2
-    fzLocal.cfg_ep1,  // EP1 config readback
-  ],
-  toZigbee: [
-    tz.on_off,                              // EP1
-    tzLocal['movement_clear_cooldown'],
-    tzLocal['occupancy_clear_cooldown'],
-    tzLocal['movement_detection_sensitivity'],
-    tzLocal['occupancy_detection_sensitivity'],
-    tzLocal['movement_detection_range'],
-    tzLocal['occupancy_detection_range'],
-  ],
-
-  exposes: [
-    e.light(),
-    e.binary('moving_target', ea.STATE, true, false).withDescription("Indicates whether the device detected movement"),
-    e.binary('static_target', ea.STATE, true, false).withDescription("Indicates whether the device detected peace"),
-    e.occupancy(),
-    exposes.numeric('movement_clear_cooldown', ea.ALL).withUnit('s').withCategory("config").withValueMin(0).withValueMax(300).withDescription("Movement clear time"),
-    exposes.numeric('occupancy_clear_cooldown', ea.ALL).withUnit('s').withCategory("config").withValueMin(0).withValueMax(65535).withDescription("Occupancy clear time"),
-    exposes.numeric('movement_detection_sensitivity', ea.ALL).withCategory("config").withValueMin(0).withValueMax(10).withDescription("Movement detection sensitivity"),
-    exposes.numeric('occupancy_detection_sensitivity', ea.ALL).withCategory("config").withValueMin(0).withValueMax(10).withDescription("Occupancy detection sensitivity"),
-    exposes.numeric('movement_detection_range', ea.ALL).withUnit('m').withCategory("config").withValueMin(0.0).withValueMax(6.0).withValueStep(0.75).withDescription("Movement detection range distance"),
-    exposes.numeric('occupancy_detection_range', ea.ALL).withUnit('m').withCategory("config").withValueMin(0.75).withValueMax(6.0).withValueStep(0.75).withDescription("Occupancy detection range distance"),
-
-  ],
-
-  configure: async (device, coordinatorEndpoint) => {
-    const ep1 = device.getEndpoint(EP1);
-    const ep2 = device.getEndpoint(EP2);
-
-    await reporting.bind(ep1, coordinatorEndpoint, ['genOnOff']);
-    await reporting.bind(ep2, coordinatorEndpoint, ['msOccupancySensing']);
-
-    try { await ep1.configureReporting('genOnOff', [{attribute: 'onOff', minimumReportInterval: 0, maximumReportInterval: 3600}]); }
-    catch { try { await reporting.onOff(ep1); } catch {} }
-    try { await ep1.read('genOnOff', ['onOff']); } catch {}
-
-    try { await ep2.configureReporting('msOccupancySensing', [{attribute: 'occupancy', minimumReportInterval: 0, maximumReportInterval: 3600, reportableChange: 0}]); }
-    catch { try { await reporting.occupancy(ep2, {min: 0, max: 3600, change: 0}); } catch {} }
-
-    const repCustom = [
-      {attribute: ATTR_MOVING_TARGET, minimumReportInterval: 0, maximumReportInterval: 3600, reportableChange: 1, dataType: BOOL_DT},
-      {attribute: ATTR_STATIC_TARGET, minimumReportInterval: 0, maximumReportInterval: 3600, reportableChange: 1, dataType: BOOL_DT},
-    ];
-    try { await ep2.configureReporting(CL_OCC, repCustom, {manufacturerCode: 0x115F}); }
-    catch { try { await ep2.configureReporting(CL_OCC, repCustom); } catch {} }
-
-    try { await ep2.read('msOccupancySensing', ['occupancy']); } catch {}
-    try { await ep2.read(CL_OCC, [ATTR_MOVING_TARGET, ATTR_STATIC_TARGET]); } catch {}
-
-    try {
-      await ep1.read(CL_CFG, [
-        ATTR_MOVEMENT_COOLDOWN, ATTR_OCC_CLEAR_COOLDOWN,
-        ATTR_MOVING_SENS_0_10, ATTR_STATIC_SENS_0_10,
-        ATTR_MOVING_MAX_GATE, ATTR_STATIC_MAX_GATE,
-      ]);
-    } catch {}
-  },
-}];
\ No newline at end of file
+export default [
+  definition('SHS01', 'ESP32-C6 LD2410C: light + Moving/Static/Occupancy + config (EP1/EP2)'),
+  definition('SHS02', 'ESP32-C6 LD2412: light + Moving/Static/Occupancy + per-gate config (EP1/EP2)'),
+  definition('SHS03', 'ESP32-C6 SEN0557: light + Occupancy + range/sensitivity config (EP1/EP2)'),
+];
\ No newline at end of file